@@ -54,15 +54,9 @@ EnvelopeLane::EnvelopeLane(juce::AudioProcessorValueTreeState& apvts, int laneNu
     destinationCombo.addItemList({ "None", "Amplitude" }, 1);
     destinationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         apvts, prefix + "_destination", destinationCombo);
-
-    // Start timer for step visualization
-    startTimerHz(30);
 }
 
-EnvelopeLane::~EnvelopeLane()
-{
-    stopTimer();
-}
+EnvelopeLane::~EnvelopeLane() = default;
 
 void EnvelopeLane::paint(juce::Graphics& g)
 {
@@ -141,12 +135,6 @@ void EnvelopeLane::resized()
     }
 }
 
-void EnvelopeLane::timerCallback()
-{
-    // Update step visualization from parent (would need processor reference)
-    // For now, rely on setCurrentStep being called from editor
-}
-
 void EnvelopeLane::setCurrentStep(int step)
 {
     if (step != currentPlayingStep)
@@ -10,14 +10,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../EnvGenConfig.h"
 #include "StepButton.h"
 #include "CustomLookAndFeel.h"
 
-class EnvelopeLane : public juce::Component,
-                     public juce::Timer
+class EnvelopeLane : public juce::Component
 {
 public:
-    static constexpr int NUM_STEPS = 16;
+    static constexpr int NUM_STEPS = EnvGenConfig::numSteps;
 
     EnvelopeLane(juce::AudioProcessorValueTreeState& apvts, int laneNumber);
     ~EnvelopeLane() override;
@@ -25,8 +25,7 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
 
-    void timerCallback() override;
-
+    // Called from the editor's refresh with the lane's playing step (-1 for none)
     void setCurrentStep(int step);
 
 private:
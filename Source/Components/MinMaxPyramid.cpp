@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    MinMaxPyramid.cpp
+    Append-only min/max point store with incrementally maintained summaries
+
+  ==============================================================================
+*/
+
+#include "MinMaxPyramid.h"
+
+void MinMaxPyramid::setCapacity(int newCapacity)
+{
+    capacity = juce::jmax(0, newCapacity);
+    length = 0;
+
+    // The points themselves, then a level per block size that still fits in the capacity
+    numLevels = 0;
+    for (int blockBits = 0; numLevels < kMaxLevels && (numLevels == 0 || (1 << blockBits) <= capacity); blockBits += kLevelBits)
+    {
+        const auto numBlocks = static_cast<size_t>((capacity >> blockBits) + 1);
+        levels[static_cast<size_t>(numLevels)].minima.assign(numBlocks, 0.0f);
+        levels[static_cast<size_t>(numLevels)].maxima.assign(numBlocks, 0.0f);
+        ++numLevels;
+    }
+}
+
+int MinMaxPyramid::append(const float* minima, const float* maxima, int numPoints)
+{
+    const int numToTake = juce::jlimit(0, capacity - length, numPoints);
+    for (int i = 0; i < numToTake; ++i)
+        appendOne(minima[i], maxima[i]);
+    return numToTake;
+}
+
+int MinMaxPyramid::appendSilence(int numPoints)
+{
+    const int numToTake = juce::jlimit(0, capacity - length, numPoints);
+    for (int i = 0; i < numToTake; ++i)
+        appendOne(0.0f, 0.0f);
+    return numToTake;
+}
+
+void MinMaxPyramid::appendOne(float lowest, float highest)
+{
+    const int index = length++;
+
+    // The first point of a block starts it afresh, so stale summaries are never combined with
+    for (int level = 0, blockBits = 0; level < numLevels; ++level, blockBits += kLevelBits)
+    {
+        auto& summary = levels[static_cast<size_t>(level)];
+        const auto block = static_cast<size_t>(index >> blockBits);
+
+        if ((index & ((1 << blockBits) - 1)) == 0)
+        {
+            summary.minima[block] = lowest;
+            summary.maxima[block] = highest;
+        }
+        else
+        {
+            summary.minima[block] = juce::jmin(summary.minima[block], lowest);
+            summary.maxima[block] = juce::jmax(summary.maxima[block], highest);
+        }
+    }
+}
+
+juce::Range<float> MinMaxPyramid::getMinMax(int start, int end) const
+{
+    start = juce::jmax(0, start);
+    end = juce::jmin(end, length);
+    if (start >= end)
+        return {};
+
+    float lowest = levels[0].minima[static_cast<size_t>(start)];
+    float highest = levels[0].maxima[static_cast<size_t>(start)];
+
+    for (int index = start; index < end;)
+    {
+        // Coarsest block that starts here and ends inside the range
+        int level = 0;
+        while (level + 1 < numLevels)
+        {
+            const int blockSize = 1 << ((level + 1) * kLevelBits);
+            if ((index & (blockSize - 1)) != 0 || index + blockSize > end)
+                break;
+            ++level;
+        }
+
+        const auto& summary = levels[static_cast<size_t>(level)];
+        const auto block = static_cast<size_t>(index >> (level * kLevelBits));
+        lowest = juce::jmin(lowest, summary.minima[block]);
+        highest = juce::jmax(highest, summary.maxima[block]);
+        index += 1 << (level * kLevelBits);
+    }
+
+    return { lowest, highest };
+}
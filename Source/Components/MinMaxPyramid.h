@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    MinMaxPyramid.h
+    Append-only min/max point store with incrementally maintained summaries
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+// Holds one measure of scope data as min/max points (a plain value is a point whose min and
+// max are equal). Level 0 is the points themselves; level L summarises blocks of 8^L points,
+// and every level is updated as points are appended. A min/max query over any range then
+// combines at most a few dozen entries (whole blocks from the coarsest level that fits,
+// finer ones at the edges), so a display column costs the same whatever the tempo or
+// sample rate.
+//
+// reset() only rewinds the length: stale data past it is never read.
+class MinMaxPyramid
+{
+public:
+    MinMaxPyramid() = default;
+    ~MinMaxPyramid() = default;
+
+    // Allocates for capacity points and empties the store (message thread)
+    void setCapacity(int newCapacity);
+    int getCapacity() const { return capacity; }
+
+    void reset() { length = 0; }
+    int getLength() const { return length; }
+
+    // Append up to the capacity; each returns how many points were taken
+    int append(const float* minima, const float* maxima, int numPoints);
+    int append(const float* values, int numPoints) { return append(values, values, numPoints); }
+    int appendSilence(int numPoints);
+
+    // Lowest minimum and highest maximum of the points in [start, end), clipped to the
+    // stored length. An empty range returns a zero-width range at 0.
+    juce::Range<float> getMinMax(int start, int end) const;
+
+private:
+    static constexpr int kLevelBits = 3;      // 8 entries per block of the next level up
+    static constexpr int kMaxLevels = 8;      // the points plus blocks of up to 8^7 points
+
+    struct Level
+    {
+        std::vector<float> minima;
+        std::vector<float> maxima;
+    };
+
+    std::array<Level, kMaxLevels> levels;     // levels[L] holds blocks of 8^L points
+    int numLevels = 0;
+    int capacity = 0;
+    int length = 0;
+
+    void appendOne(float lowest, float highest);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MinMaxPyramid)
+};
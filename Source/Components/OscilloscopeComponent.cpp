@@ -1,47 +1,163 @@
 #include "OscilloscopeComponent.h"
 
+namespace
+{
+    // Until prepare() says otherwise
+    constexpr double kDefaultSampleRate = 44100.0;
+    constexpr int kDefaultBlockSize = 512;
+    constexpr double kDefaultMeasureSeconds = 16.0;
+
+    // The FIFO has to hold everything pushed between two drains at the idle refresh rate,
+    // with room for a late message thread
+    constexpr double kFifoDrainSeconds = 1.0 / RefreshDriver::defaultIdleRateHz;
+    constexpr double kFifoHeadroom = 2.0;
+
+    // Each host block pushes a playhead record, then for every chunk of at most
+    // ScopeDataSink::maxPointsPerPush points one audio record (min + max) and one record per lane
+    struct FifoCapacity
+    {
+        int values = 0;
+        int records = 0;
+    };
+
+    FifoCapacity getFifoCapacity(double sampleRate, int maxBlockSize)
+    {
+        const int samplesPerPoint = ScopeDataSink::getSamplesPerPoint(sampleRate);
+        const int blockSize = juce::jmax(1, maxBlockSize);
+
+        // The decimators carry a partial point over, so a block can end one point long
+        const int pointsPerBlock = blockSize / samplesPerPoint + 1;
+        const int chunksPerBlock = (pointsPerBlock + ScopeDataSink::maxPointsPerPush - 1) / ScopeDataSink::maxPointsPerPush;
+        const int blocksPerDrain = static_cast<int>(std::ceil(kFifoHeadroom * kFifoDrainSeconds * sampleRate / blockSize));
+
+        FifoCapacity capacity;
+        capacity.records = blocksPerDrain * (1 + chunksPerBlock * (1 + kMaxEnvelopeLanes));
+        capacity.values = blocksPerDrain * pointsPerBlock * (2 + kMaxEnvelopeLanes);
+
+        // Whatever the settings, a whole chunk must fit
+        capacity.values = juce::jmax(capacity.values, 2 * (2 + kMaxEnvelopeLanes) * ScopeDataSink::maxPointsPerPush);
+        return capacity;
+    }
+
+    // 1-4-6-4-1 kernel inside, 1-2-1 next to the ends, end points as they are
+    void smoothEnvelope(const float* input, float* output, int size)
+    {
+        using FVO = juce::FloatVectorOperations;
+        if (size < 3)
+        {
+            FVO::copy(output, input, size);
+            return;
+        }
+
+        output[0] = input[0];
+        output[size - 1] = input[size - 1];
+        output[1] = (input[0] + 2.0f * input[1] + input[2]) * 0.25f;
+        output[size - 2] = (input[size - 3] + 2.0f * input[size - 2] + input[size - 1]) * 0.25f;
+
+        const int inner = size - 4;
+        if (inner <= 0)
+            return;
+
+        FVO::copyWithMultiply(output + 2, input + 2, 6.0f / 16.0f, inner);
+        FVO::addWithMultiply(output + 2, input + 1, 4.0f / 16.0f, inner);
+        FVO::addWithMultiply(output + 2, input + 3, 4.0f / 16.0f, inner);
+        FVO::addWithMultiply(output + 2, input, 1.0f / 16.0f, inner);
+        FVO::addWithMultiply(output + 2, input + 4, 1.0f / 16.0f, inner);
+    }
+
+    int getMeasureCapacity(double sampleRate, double maxMeasureSeconds)
+    {
+        return static_cast<int>(std::ceil(maxMeasureSeconds * sampleRate / ScopeDataSink::getSamplesPerPoint(sampleRate))) + 1;
+    }
+}
+
 OsciloscopeComponent::OsciloscopeComponent()
-    : measureBufferWritePosition(0)
-    , measureBufferCapacity(192000) // ~4 seconds at 48kHz - enough for slow tempos
+    : scopeFifo(getFifoCapacity(kDefaultSampleRate, kDefaultBlockSize).values,
+                getFifoCapacity(kDefaultSampleRate, kDefaultBlockSize).records)
+    , measureBufferCapacity(getMeasureCapacity(kDefaultSampleRate, kDefaultMeasureSeconds))
     , lastPPQPosition(-1.0)
     , ppqAtMeasureStart(0.0)
     , quarterNotesPerBar(4.0)
     , lastBPM(120.0)
-    , lastSampleRate(44100.0)
-    , samplesInCurrentMeasure(0)
+    , lastSampleRate(kDefaultSampleRate)
+    , pointsInCurrentMeasure(0)
     , hasValidPlayheadInfo(false)
     , isNewMeasure(false)
     , verticalZoom(1.0f)
-    , refreshRateHz(30)
     , backgroundColour(juce::Colour(0xff1a1a1a))
     , waveformColour(juce::Colour(0xff00ff00))
     , gridColour(juce::Colour(0xff333333))
     , envelopeColour(juce::Colour(0xff00ffaa))  // Cyan-green for envelope
     , showGrid(true)
     , showEnvelope(true)
+    , envelopeDisplayPeak(0.0f)
     , needsDisplayUpdate(false)
+    , needsFullRepaint(true)
+    , staticLayerScale(0.0f)
 {
     // Initialize measure buffers
-    measureBuffer.resize(measureBufferCapacity, 0.0f);
-    for (auto& buf : envelopeMeasureBuffers)
-        buf.resize(static_cast<size_t>(measureBufferCapacity), 0.0f);
+    measurePoints.setCapacity(measureBufferCapacity);
+    for (auto& envelope : envelopeMeasures)
+        envelope.setCapacity(measureBufferCapacity);
     
     // Initialize playhead info
     playheadInfo.resetToDefault();
+
+    // The static layer covers every pixel, so partial repaints never reach the parent
+    setOpaque(true);
+}
+
+OsciloscopeComponent::~OsciloscopeComponent() = default;
+
+void OsciloscopeComponent::paint(juce::Graphics& g)
+{
+    auto displayArea = getDisplayArea();
+
+    // Background, border, grid and centre line come from the cached layer
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (!staticLayer.isValid() || staticLayerScale != scale)
+        renderStaticLayer(scale);
+    g.drawImageTransformed(staticLayer, juce::AffineTransform::scale(1.0f / staticLayerScale));
+
+    // Only the columns inside the clip need drawing (plus the neighbours whose lines reach into it)
+    const auto clip = g.getClipBounds();
+    const juce::Range<int> columns(juce::jmax(0, clip.getX() - displayArea.getX() - 2),
+                                   juce::jmax(0, clip.getRight() - displayArea.getX() + 2));
+
+    // Draw envelope(s) first (behind waveform) unless an overlay callback is set (overlay draws it)
+    if (showEnvelope && !envelopeOverlayCallback)
+        drawEnvelope(g, displayArea, columns);
     
-    // Start display timer
-    startTimerHz(refreshRateHz);
+    // Draw waveform
+    drawWaveform(g, displayArea, columns);
+}
+
+void OsciloscopeComponent::resized()
+{
+    // Component resized - rebuild the static layer and redraw everything
+    needsDisplayUpdate = true;
+    invalidateStaticLayer();
 }
 
-OsciloscopeComponent::~OsciloscopeComponent()
+void OsciloscopeComponent::invalidateStaticLayer()
 {
-    stopTimer();
+    staticLayer = {};
+    needsFullRepaint = true;
+    repaint();
 }
 
-void OsciloscopeComponent::paint(juce::Graphics& g)
+void OsciloscopeComponent::renderStaticLayer(float scale)
 {
-    auto bounds = getLocalBounds();
-    
+    const auto bounds = getLocalBounds();
+    staticLayerScale = juce::jmax(1.0f, scale);
+    staticLayer = juce::Image(juce::Image::ARGB,
+                              juce::jmax(1, juce::roundToInt(static_cast<float>(bounds.getWidth()) * staticLayerScale)),
+                              juce::jmax(1, juce::roundToInt(static_cast<float>(bounds.getHeight()) * staticLayerScale)),
+                              true);
+
+    juce::Graphics g(staticLayer);
+    g.addTransform(juce::AffineTransform::scale(staticLayerScale));
+
     // Fill background
     g.fillAll(backgroundColour);
     
@@ -49,7 +165,7 @@ void OsciloscopeComponent::paint(juce::Graphics& g)
     g.setColour(gridColour.brighter(0.3f));
     g.drawRoundedRectangle(bounds.toFloat(), 2.0f, 1.0f);
     
-    auto displayArea = bounds.reduced(2);
+    auto displayArea = getDisplayArea();
     
     // Draw grid if enabled
     if (showGrid)
@@ -59,54 +175,64 @@ void OsciloscopeComponent::paint(juce::Graphics& g)
     g.setColour(gridColour.brighter(0.5f));
     int centerY = displayArea.getCentreY();
     g.drawHorizontalLine(centerY, static_cast<float>(displayArea.getX()), static_cast<float>(displayArea.getRight()));
-    
-    // Draw envelope(s) first (behind waveform) unless an overlay callback is set (overlay draws it)
-    if (showEnvelope && !envelopeOverlayCallback)
-        drawEnvelope(g, displayArea);
-    
-    // Draw waveform
-    drawWaveform(g, displayArea);
 }
 
-void OsciloscopeComponent::resized()
+void OsciloscopeComponent::repaintColumns(juce::Range<int> columns)
 {
-    // Component resized - trigger display update
-    needsDisplayUpdate = true;
+    // Widen by the band overlap and the 2px envelope stroke
+    const auto displayArea = getDisplayArea();
+    const int left = displayArea.getX() + columns.getStart() - 2;
+    const int right = displayArea.getX() + columns.getEnd() + 2;
+    repaint(left, 0, right - left, getHeight());
 }
 
-void OsciloscopeComponent::timerCallback()
+bool OsciloscopeComponent::wantsActiveRate() const
 {
+    return hasValidPlayheadInfo && playheadInfo.isPlaying;
+}
+
+void OsciloscopeComponent::refresh()
+{
+    if (prepareRequested.exchange(false))
+        applyPreparedSettings();
+
+    {
+        const juce::ScopedLock lock(fifoCapacityLock);
+        if (scopeFifo.drain(*this) > 0)
+            needsDisplayUpdate = true;
+    }
+
     if (needsDisplayUpdate)
     {
-        updateDisplayBuffer();
+        // Within a measure new data only lands to the right, so usually only a few
+        // columns changed since the last refresh
+        const auto dirtyColumns = updateDisplayBuffer();
         needsDisplayUpdate = false;
-        repaint();
+        if (needsFullRepaint)
+        {
+            needsFullRepaint = false;
+            repaint();
+        }
+        else if (!dirtyColumns.isEmpty())
+        {
+            repaintColumns(dirtyColumns);
+        }
+
         if (envelopeOverlayCallback)
         {
-            std::array<std::vector<float>, kMaxEnvelopeLanes> copies;
+            // Hands over pointers to the persistent smoothed buffers: nothing is copied
             std::array<const float*, kMaxEnvelopeLanes> ptrs;
             std::array<int, kMaxEnvelopeLanes> sizes;
             juce::Colour colours[kMaxEnvelopeLanes];
             int numLanes = 0;
+            for (int i = 0; i < kMaxEnvelopeLanes; ++i)
             {
-                const juce::ScopedLock lock(bufferLock);
-                for (int i = 0; i < kMaxEnvelopeLanes; ++i)
-                {
-                    if (!envelopeDisplayBuffers[static_cast<size_t>(i)].empty())
-                    {
-                        copies[static_cast<size_t>(i)] = envelopeDisplayBuffers[static_cast<size_t>(i)];
-                        ptrs[static_cast<size_t>(i)] = copies[static_cast<size_t>(i)].data();
-                        sizes[static_cast<size_t>(i)] = static_cast<int>(copies[static_cast<size_t>(i)].size());
-                        colours[i] = getLaneColour(i);
-                        numLanes = i + 1;
-                    }
-                    else
-                    {
-                        ptrs[static_cast<size_t>(i)] = nullptr;
-                        sizes[static_cast<size_t>(i)] = 0;
-                        colours[i] = getLaneColour(i);
-                    }
-                }
+                const auto& buf = smoothedEnvelopeBuffers[static_cast<size_t>(i)];
+                ptrs[static_cast<size_t>(i)] = buf.empty() ? nullptr : buf.data();
+                sizes[static_cast<size_t>(i)] = static_cast<int>(buf.size());
+                colours[i] = getLaneColour(i);
+                if (!buf.empty())
+                    numLanes = i + 1;
             }
             if (numLanes > 0)
                 envelopeOverlayCallback(ptrs.data(), sizes.data(), numLanes, colours);
@@ -114,64 +240,75 @@ void OsciloscopeComponent::timerCallback()
     }
 }
 
-void OsciloscopeComponent::pushBuffer(const float* samples, int numSamples)
+void OsciloscopeComponent::prepare(double sampleRate, int maxBlockSize, double maxMeasureSeconds)
 {
-    const juce::ScopedLock lock(bufferLock);
-    
-    // Add samples to the measure buffer
-    for (int i = 0; i < numSamples; ++i)
+    // The audio thread isn't pushing to this sink, so only a drain can be in the way. The
+    // measure storage is left to the next refresh.
+    const auto capacity = getFifoCapacity(sampleRate, maxBlockSize);
     {
-        if (measureBufferWritePosition < measureBufferCapacity)
-        {
-            measureBuffer[measureBufferWritePosition] = samples[i];
-            measureBufferWritePosition++;
-        }
-        else
-        {
-            // Buffer full - stop writing
-            break;
-        }
+        const juce::ScopedLock lock(fifoCapacityLock);
+        scopeFifo.setCapacity(capacity.values, capacity.records);
     }
-    
-    // Track total samples in this measure
-    samplesInCurrentMeasure += numSamples;
-    
-    needsDisplayUpdate = true;
+
+    preparedSampleRate.store(sampleRate);
+    preparedMeasureSeconds.store(maxMeasureSeconds);
+    prepareRequested.store(true);
 }
 
-void OsciloscopeComponent::pushEnvelopeBuffer(const float* samples, int numSamples)
+void OsciloscopeComponent::pushAudioPoints(const float* minima, const float* maxima, int numPoints)
 {
-    pushEnvelopeBuffer(samples, numSamples, 0);
+    scopeFifo.pushAudio(minima, maxima, numPoints);
 }
 
-void OsciloscopeComponent::pushEnvelopeBuffer(const float* samples, int numSamples, int laneIndex)
+void OsciloscopeComponent::pushEnvelopePoints(const float* peaks, int numPoints, int laneIndex)
 {
-    if (laneIndex < 0 || laneIndex >= kMaxEnvelopeLanes)
-        return;
-    const juce::ScopedLock lock(bufferLock);
-    auto& buf = envelopeMeasureBuffers[static_cast<size_t>(laneIndex)];
-    if (buf.size() != static_cast<size_t>(measureBufferCapacity))
-        buf.resize(static_cast<size_t>(measureBufferCapacity), 0.0f);
-    int startPos = measureBufferWritePosition - numSamples;
-    if (startPos < 0) startPos = 0;
-    for (int i = 0; i < numSamples; ++i)
-    {
-        int writePos = startPos + i;
-        if (writePos >= 0 && writePos < measureBufferCapacity)
-            buf[static_cast<size_t>(writePos)] = samples[i];
-    }
+    if (laneIndex >= 0 && laneIndex < kMaxEnvelopeLanes)
+        scopeFifo.pushEnvelope(peaks, numPoints, laneIndex);
 }
 
 void OsciloscopeComponent::updatePlayheadInfo(const juce::AudioPlayHead::CurrentPositionInfo& info)
 {
-    const juce::ScopedLock lock(bufferLock);
-    
+    scopeFifo.pushPlayhead(info);
+}
+
+//==============================================================================
+void OsciloscopeComponent::handleAudio(const float* minima, const float* maxima, int numPoints)
+{
+    // Add points to the measure buffer (anything past its capacity is dropped)
+    measurePoints.append(minima, maxima, numPoints);
+
+    // Track total points in this measure
+    pointsInCurrentMeasure += numPoints;
+}
+
+void OsciloscopeComponent::handleEnvelope(const float* peaks, int numPoints, int laneIndex)
+{
+    // A block's envelope lines up with the audio points pushed just before it
+    auto& envelope = envelopeMeasures[static_cast<size_t>(laneIndex)];
+    const int blockStart = juce::jmax(0, measurePoints.getLength() - numPoints);
+
+    // A lane that skipped blocks (e.g. switched on mid-measure) was silent until now
+    if (envelope.getLength() < blockStart)
+        envelope.appendSilence(blockStart - envelope.getLength());
+
+    const int alreadyStored = envelope.getLength() - blockStart;
+    if (alreadyStored < numPoints)
+        envelope.append(peaks + alreadyStored, numPoints - alreadyStored);
+}
+
+void OsciloscopeComponent::handlePlayhead(const juce::AudioPlayHead::CurrentPositionInfo& info)
+{
     hasValidPlayheadInfo = true;
     
     // Calculate quarter notes per bar based on time signature
     if (info.timeSigNumerator > 0 && info.timeSigDenominator > 0)
     {
-        quarterNotesPerBar = (4.0 * info.timeSigNumerator) / info.timeSigDenominator;
+        const double newQuarterNotesPerBar = (4.0 * info.timeSigNumerator) / info.timeSigDenominator;
+        if (newQuarterNotesPerBar != quarterNotesPerBar)
+        {
+            quarterNotesPerBar = newQuarterNotesPerBar;
+            invalidateStaticLayer();
+        }
     }
     
     // Track BPM and sample rate changes
@@ -216,88 +353,160 @@ void OsciloscopeComponent::updatePlayheadInfo(const juce::AudioPlayHead::Current
     lastPPQPosition = info.ppqPosition;
 }
 
+void OsciloscopeComponent::handleOverflow()
+{
+    // Part of the stream is missing: start over at the next playhead record
+    resetMeasureBuffer();
+    lastPPQPosition = -1.0;
+}
+
 void OsciloscopeComponent::setVerticalZoom(float zoom)
 {
     verticalZoom = juce::jlimit(0.1f, 10.0f, zoom);
+    needsFullRepaint = true;
     repaint();
 }
 
 void OsciloscopeComponent::resetMeasureBuffer()
 {
-    std::fill(measureBuffer.begin(), measureBuffer.end(), 0.0f);
-    for (auto& buf : envelopeMeasureBuffers)
-        std::fill(buf.begin(), buf.end(), 0.0f);
-    measureBufferWritePosition = 0;
-    samplesInCurrentMeasure = 0;
+    // O(1): the old measure's samples stay in place but fall outside the stored lengths
+    measurePoints.reset();
+    for (auto& envelope : envelopeMeasures)
+        envelope.reset();
+    pointsInCurrentMeasure = 0;
 }
 
-void OsciloscopeComponent::updateDisplayBuffer()
+void OsciloscopeComponent::applyPreparedSettings()
 {
-    const juce::ScopedLock lock(bufferLock);
-    
-    int width = getWidth();
-    if (width <= 0)
+    const double sampleRate = preparedSampleRate.load();
+    const double maxMeasureSeconds = preparedMeasureSeconds.load();
+    if (sampleRate <= 0.0 || maxMeasureSeconds <= 0.0)
         return;
-    
-    if (displayBuffer.size() != static_cast<size_t>(width))
-        displayBuffer.resize(static_cast<size_t>(width), 0.0f);
-    for (auto& buf : envelopeDisplayBuffers)
+
+    lastSampleRate = sampleRate;
+
+    const int capacity = getMeasureCapacity(sampleRate, maxMeasureSeconds);
+    if (capacity != measureBufferCapacity)
     {
-        if (buf.size() != static_cast<size_t>(width))
-            buf.resize(static_cast<size_t>(width), 0.0f);
+        measureBufferCapacity = capacity;
+        measurePoints.setCapacity(measureBufferCapacity);
+        for (auto& envelope : envelopeMeasures)
+            envelope.setCapacity(measureBufferCapacity);
     }
+
+    // Points already in the FIFO may be at the old rate: start over at the next playhead
+    resetMeasureBuffer();
+    lastPPQPosition = -1.0;
+    needsDisplayUpdate = true;
+}
+
+juce::Range<int> OsciloscopeComponent::updateDisplayBuffer()
+{
+    int width = getDisplayArea().getWidth();
+    if (width <= 0)
+        return {};
     
-    if (measureBufferWritePosition == 0)
+    if (displayBuffer.size() != static_cast<size_t>(width))
     {
-        std::fill(displayBuffer.begin(), displayBuffer.end(), 0.0f);
+        displayBuffer.assign(static_cast<size_t>(width), {});
         for (auto& buf : envelopeDisplayBuffers)
-            std::fill(buf.begin(), buf.end(), 0.0f);
-        return;
+            buf.assign(static_cast<size_t>(width), 0.0f);
+        needsFullRepaint = true;
     }
     
-    // Calculate expected total samples in a measure using BPM and sample rate
-    int expectedTotalSamples = measureBufferCapacity;
+    // Calculate expected total points in a measure using BPM and sample rate
+    int expectedTotalPoints = measureBufferCapacity;
     if (lastBPM > 0.0 && lastSampleRate > 0.0 && quarterNotesPerBar > 0.0)
     {
-        // Calculate samples per quarter note
+        // Calculate points per quarter note
         double secondsPerQuarterNote = 60.0 / lastBPM;
-        double samplesPerQuarterNote = secondsPerQuarterNote * lastSampleRate;
+        double pointsPerQuarterNote = secondsPerQuarterNote * lastSampleRate / ScopeDataSink::getSamplesPerPoint(lastSampleRate);
         
-        // Total samples in a measure
-        expectedTotalSamples = static_cast<int>(samplesPerQuarterNote * quarterNotesPerBar);
-        expectedTotalSamples = juce::jlimit(1, measureBufferCapacity, expectedTotalSamples);
+        // Total points in a measure
+        expectedTotalPoints = static_cast<int>(pointsPerQuarterNote * quarterNotesPerBar);
+        expectedTotalPoints = juce::jlimit(1, measureBufferCapacity, expectedTotalPoints);
     }
     
-    // Map samples to pixels: waveform = one sample per pixel; envelope = peak-hold per pixel column
-    const float widthF = static_cast<float>(width);
+    // Map points to pixels: each column summarises its span of the measure through the
+    // min/max pyramids, so the cost per column doesn't depend on how many points it covers.
+    // Waveform = min/max band; envelope = per-lane peak-hold. Columns whose values didn't
+    // change are left out of the returned range.
+    int firstDirty = width;
+    int lastDirty = -1;
+    envelopeLaneChanged.fill(false);
+    auto markDirty = [&](int x)
+    {
+        firstDirty = juce::jmin(firstDirty, x);
+        lastDirty = juce::jmax(lastDirty, x);
+    };
+
+    const double pointsPerPixel = expectedTotalPoints / static_cast<double>(width);
     for (int x = 0; x < width; ++x)
     {
-        // Waveform: single sample per pixel (unchanged)
-        float sampleIndex = (x / widthF) * expectedTotalSamples;
-        int index = static_cast<int>(sampleIndex);
-        if (index < measureBufferWritePosition)
-            displayBuffer[x] = measureBuffer[index];
-        else
-            displayBuffer[x] = 0.0f;
-
-        // Envelope: per-lane peak-hold
-        int startIdx = static_cast<int>((x / widthF) * expectedTotalSamples);
-        int endIdx = static_cast<int>(((x + 1) / widthF) * expectedTotalSamples);
-        if (endIdx <= startIdx)
-            endIdx = startIdx + 1;
-        startIdx = juce::jlimit(0, measureBufferWritePosition, startIdx);
-        endIdx = juce::jlimit(0, measureBufferWritePosition, endIdx);
+        const int startIdx = static_cast<int>(x * pointsPerPixel);
+        const int endIdx = juce::jmax(startIdx + 1, static_cast<int>((x + 1) * pointsPerPixel));
+
+        // Overlap the previous column by one point so adjacent bands always join up
+        const auto band = measurePoints.getMinMax(juce::jmax(0, startIdx - 1), endIdx);
+        if (band != displayBuffer[static_cast<size_t>(x)])
+        {
+            displayBuffer[static_cast<size_t>(x)] = band;
+            markDirty(x);
+        }
+
         for (int lane = 0; lane < kMaxEnvelopeLanes; ++lane)
         {
-            const auto& measBuf = envelopeMeasureBuffers[static_cast<size_t>(lane)];
-            if (measBuf.empty())
+            const float peak = envelopeMeasures[static_cast<size_t>(lane)].getMinMax(startIdx, endIdx).getEnd();
+            auto& column = envelopeDisplayBuffers[static_cast<size_t>(lane)][static_cast<size_t>(x)];
+            if (peak != column)
+            {
+                column = peak;
+                envelopeLaneChanged[static_cast<size_t>(lane)] = true;
+                markDirty(x);
+            }
+        }
+    }
+
+    // The envelope is smoothed over 5 columns and scaled to its peak, so a change spreads
+    // 2 columns either way, and a new peak rescales every column. Only lanes whose columns
+    // changed are smoothed again.
+    if (showEnvelope || envelopeOverlayCallback)
+    {
+        float peak = 0.0f;
+        for (int lane = 0; lane < kMaxEnvelopeLanes; ++lane)
+        {
+            const auto& dispBuf = envelopeDisplayBuffers[static_cast<size_t>(lane)];
+            auto& smoothed = smoothedEnvelopeBuffers[static_cast<size_t>(lane)];
+            if (smoothed.size() != dispBuf.size())
+                smoothed.assign(dispBuf.size(), 0.0f);
+            else if (!envelopeLaneChanged[static_cast<size_t>(lane)])
+            {
+                peak = juce::jmax(peak, smoothedEnvelopePeaks[static_cast<size_t>(lane)]);
                 continue;
-            float peak = 0.0f;
-            for (int k = startIdx; k < endIdx; ++k)
-                peak = juce::jmax(peak, measBuf[static_cast<size_t>(k)]);
-            envelopeDisplayBuffers[static_cast<size_t>(lane)][static_cast<size_t>(x)] = peak;
+            }
+
+            smoothEnvelope(dispBuf.data(), smoothed.data(), width);
+            smoothedEnvelopePeaks[static_cast<size_t>(lane)] = juce::FloatVectorOperations::findMaximum(smoothed.data(), width);
+            envelopeLaneChanged[static_cast<size_t>(lane)] = true;
+            peak = juce::jmax(peak, smoothedEnvelopePeaks[static_cast<size_t>(lane)]);
+        }
+
+        // With an overlay callback the envelope isn't drawn here, so it doesn't widen repaints
+        const bool drawsEnvelope = showEnvelope && !envelopeOverlayCallback;
+        if (peak != envelopeDisplayPeak)
+        {
+            envelopeDisplayPeak = peak;
+            needsFullRepaint = needsFullRepaint || drawsEnvelope;
+        }
+
+        if (drawsEnvelope && lastDirty >= 0)
+        {
+            firstDirty = juce::jmax(0, firstDirty - 2);
+            lastDirty = juce::jmin(width - 1, lastDirty + 2);
         }
     }
+
+    return lastDirty >= 0 ? juce::Range<int>(firstDirty, lastDirty + 1) : juce::Range<int>();
 }
 
 void OsciloscopeComponent::drawGrid(juce::Graphics& g, juce::Rectangle<int> bounds)
@@ -367,47 +576,43 @@ void OsciloscopeComponent::drawGrid(juce::Graphics& g, juce::Rectangle<int> boun
     }
 }
 
-void OsciloscopeComponent::drawWaveform(juce::Graphics& g, juce::Rectangle<int> bounds)
+void OsciloscopeComponent::drawWaveform(juce::Graphics& g, juce::Rectangle<int> bounds, juce::Range<int> columns)
 {
     if (displayBuffer.empty())
         return;
     
     g.setColour(waveformColour);
     
-    juce::Path wavePath;
-    bool pathStarted = false;
-    
     int width = bounds.getWidth();
     int height = bounds.getHeight();
     int centerY = bounds.getCentreY();
+    const float top = static_cast<float>(bounds.getY());
+    const float bottom = static_cast<float>(bounds.getBottom());
     
-    // Draw the waveform - one pixel per display buffer sample
-    int samplesToDraw = juce::jmin(width, static_cast<int>(displayBuffer.size()));
+    // Draw the waveform as a min/max band - one vertical span per pixel column, at least
+    // 1.5px tall so silent and flat stretches still show as a line
+    columns = columns.getIntersectionWith({ 0, juce::jmin(width, static_cast<int>(displayBuffer.size())) });
+    auto& band = waveformBand;
+    band.clear();
+    band.ensureStorageAllocated(columns.getLength());
     
-    for (int x = 0; x < samplesToDraw; ++x)
+    for (int x = columns.getStart(); x < columns.getEnd(); ++x)
     {
-        float sample = displayBuffer[x];
-        float y = getScaledSample(sample, height);
-        float pixelY = centerY - y;
-        
-        // Clamp to bounds
-        pixelY = juce::jlimit(static_cast<float>(bounds.getY()),
-                            static_cast<float>(bounds.getBottom()),
-                            pixelY);
+        const auto range = displayBuffer[static_cast<size_t>(x)];
+        float upper = juce::jlimit(top, bottom, centerY - getScaledSample(range.getEnd(), height));
+        float lower = juce::jlimit(top, bottom, centerY - getScaledSample(range.getStart(), height));
         
-        if (!pathStarted)
+        if (lower - upper < 1.5f)
         {
-            wavePath.startNewSubPath(static_cast<float>(bounds.getX() + x), pixelY);
-            pathStarted = true;
-        }
-        else
-        {
-            wavePath.lineTo(static_cast<float>(bounds.getX() + x), pixelY);
+            const float middle = 0.5f * (upper + lower);
+            upper = middle - 0.75f;
+            lower = middle + 0.75f;
         }
+        
+        band.addWithoutMerging({ static_cast<float>(bounds.getX() + x), upper, 1.0f, lower - upper });
     }
     
-    // Draw the path
-    g.strokePath(wavePath, juce::PathStrokeType(1.5f));
+    g.fillRectList(band);
 }
 
 juce::Colour OsciloscopeComponent::getLaneColour(int laneIndex)
@@ -422,62 +627,30 @@ juce::Colour OsciloscopeComponent::getLaneColour(int laneIndex)
         juce::Colour(0xffff7043),  // 6: coral
         juce::Colour(0xffb39ddb),  // 7: lavender
     };
-    int i = juce::jlimit(0, kMaxEnvelopeLanes - 1, laneIndex);
-    return palette[i];
+    return palette[juce::jmax(0, laneIndex) % juce::numElementsInArray(palette)];
 }
 
-void OsciloscopeComponent::drawEnvelope(juce::Graphics& g, juce::Rectangle<int> bounds)
+void OsciloscopeComponent::drawEnvelope(juce::Graphics& g, juce::Rectangle<int> bounds, juce::Range<int> columns)
 {
     int width = bounds.getWidth();
     int height = bounds.getHeight();
-    if (width <= 0 || height <= 0)
+    if (width <= 0 || height <= 0 || envelopeDisplayPeak < 0.01f)
         return;
 
-    float maxEnvValue = 0.0f;
-    const float one16 = 1.0f / 16.0f;
+    // Smoothing and the peak were worked out in updateDisplayBuffer()
+    float envelopeScale = (height * 0.9f) / envelopeDisplayPeak;
 
     for (int lane = 0; lane < kMaxEnvelopeLanes; ++lane)
     {
-        const auto& dispBuf = envelopeDisplayBuffers[static_cast<size_t>(lane)];
-        int samplesToDraw = juce::jmin(width, static_cast<int>(dispBuf.size()));
-        if (samplesToDraw <= 0)
+        const auto& smoothed = smoothedEnvelopeBuffers[static_cast<size_t>(lane)];
+        const auto laneColumns = columns.getIntersectionWith({ 0, juce::jmin(width, static_cast<int>(smoothed.size())) });
+        if (laneColumns.isEmpty())
             continue;
-        for (int x = 0; x < samplesToDraw; ++x)
-        {
-            float v = dispBuf[static_cast<size_t>(x)];
-            if (x >= 2 && x < samplesToDraw - 2)
-                v = (dispBuf[static_cast<size_t>(x - 2)] + 4.0f * dispBuf[static_cast<size_t>(x - 1)]
-                     + 6.0f * v + 4.0f * dispBuf[static_cast<size_t>(x + 1)] + dispBuf[static_cast<size_t>(x + 2)]) * one16;
-            else if (x > 0 && x < samplesToDraw - 1)
-                v = (dispBuf[static_cast<size_t>(x - 1)] + 2.0f * v + dispBuf[static_cast<size_t>(x + 1)]) * 0.25f;
-            maxEnvValue = juce::jmax(maxEnvValue, v);
-        }
-    }
-    if (maxEnvValue < 0.01f)
-        return;
-    float envelopeScale = (height * 0.9f) / maxEnvValue;
-
-    for (int lane = 0; lane < kMaxEnvelopeLanes; ++lane)
-    {
-        const auto& dispBuf = envelopeDisplayBuffers[static_cast<size_t>(lane)];
-        int samplesToDraw = juce::jmin(width, static_cast<int>(dispBuf.size()));
-        if (samplesToDraw <= 0)
-            continue;
-        std::vector<float> smoothed(static_cast<size_t>(samplesToDraw));
-        for (int x = 0; x < samplesToDraw; ++x)
-        {
-            float v = dispBuf[static_cast<size_t>(x)];
-            if (x >= 2 && x < samplesToDraw - 2)
-                v = (dispBuf[static_cast<size_t>(x - 2)] + 4.0f * dispBuf[static_cast<size_t>(x - 1)]
-                     + 6.0f * v + 4.0f * dispBuf[static_cast<size_t>(x + 1)] + dispBuf[static_cast<size_t>(x + 2)]) * one16;
-            else if (x > 0 && x < samplesToDraw - 1)
-                v = (dispBuf[static_cast<size_t>(x - 1)] + 2.0f * v + dispBuf[static_cast<size_t>(x + 1)]) * 0.25f;
-            smoothed[static_cast<size_t>(x)] = v;
-        }
         g.setColour(getLaneColour(lane).withAlpha(0.8f));
-        juce::Path envPath;
+        auto& envPath = envelopePath;
+        envPath.clear();
         bool pathStarted = false;
-        for (int x = 0; x < samplesToDraw; ++x)
+        for (int x = laneColumns.getStart(); x < laneColumns.getEnd(); ++x)
         {
             float pixelY = bounds.getBottom() - (smoothed[static_cast<size_t>(x)] * envelopeScale);
             pixelY = juce::jlimit(static_cast<float>(bounds.getY()), static_cast<float>(bounds.getBottom()), pixelY);
@@ -1,16 +1,22 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../EnvGenConfig.h"
 #include "../ScopeDataSink.h"
+#include "../ScopeFifo.h"
+#include "MinMaxPyramid.h"
+#include "RefreshDriver.h"
 #include <array>
+#include <atomic>
 #include <functional>
 #include <vector>
 
-static constexpr int kMaxEnvelopeLanes = 8;
+static constexpr int kMaxEnvelopeLanes = EnvGenConfig::numLanes;
 
 class OsciloscopeComponent : public juce::Component,
-                              public juce::Timer,
-                              public ScopeDataSink
+                              public RefreshDriver::Client,
+                              public ScopeDataSink,
+                              private ScopeFifo::Reader
 {
 public:
     OsciloscopeComponent();
@@ -20,40 +26,58 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
-    // Timer callback for display updates
-    void timerCallback() override;
+    // RefreshDriver::Client: drains the FIFO and repaints what changed. The editor's
+    // driver runs it at the full rate while the transport plays.
+    void refresh() override;
+    bool wantsActiveRate() const override;
     
-    // ScopeDataSink interface
-    void pushBuffer(const float* samples, int numSamples) override;
-    void pushEnvelopeBuffer(const float* samples, int numSamples) override;
-    void pushEnvelopeBuffer(const float* samples, int numSamples, int laneIndex) override;
+    // ScopeDataSink interface. prepare() may come from any thread but the audio thread; it
+    // resizes the FIFO, and the measure storage follows on the next refresh. The pushes only
+    // hand the data to the FIFO.
+    void prepare(double sampleRate, int maxBlockSize, double maxMeasureSeconds) override;
+    void pushAudioPoints(const float* minima, const float* maxima, int numPoints) override;
+    void pushEnvelopePoints(const float* peaks, int numPoints, int laneIndex) override;
     void updatePlayheadInfo(const juce::AudioPlayHead::CurrentPositionInfo& info) override;
     
     // Configuration
-    void setRefreshRate(int hz) { startTimerHz(hz); }
     void setVerticalZoom(float zoom);
     
     // Visual settings
-    void setBackgroundColour(juce::Colour colour) { backgroundColour = colour; }
-    void setWaveformColour(juce::Colour colour) { waveformColour = colour; }
-    void setGridColour(juce::Colour colour) { gridColour = colour; }
-    void setEnvelopeColour(juce::Colour colour) { envelopeColour = colour; }
-    void setShowGrid(bool show) { showGrid = show; }
-    void setShowEnvelope(bool show) { showEnvelope = show; }
+    void setBackgroundColour(juce::Colour colour) { backgroundColour = colour; invalidateStaticLayer(); }
+    void setWaveformColour(juce::Colour colour) { waveformColour = colour; repaint(); }
+    void setGridColour(juce::Colour colour) { gridColour = colour; invalidateStaticLayer(); }
+    void setEnvelopeColour(juce::Colour colour) { envelopeColour = colour; repaint(); }
+    void setShowGrid(bool show) { showGrid = show; invalidateStaticLayer(); }
+    void setShowEnvelope(bool show) { showEnvelope = show; repaint(); }
 
     /** When set, the scope does not draw the envelope in paint(); instead it calls this
-        with per-lane display buffers and colours. buffers[i] has size sizes[i]; numLanes up to kMaxEnvelopeLanes. */
+        with per-lane display buffers (already smoothed) and colours. buffers[i] has size sizes[i];
+        numLanes up to kMaxEnvelopeLanes. The buffers belong to the scope and are only valid
+        during the call. */
     using EnvelopeOverlayCallback = std::function<void(const float* const* buffers, const int* sizes, int numLanes, const juce::Colour* colours)>;
     void setEnvelopeOverlayCallback(EnvelopeOverlayCallback cb) { envelopeOverlayCallback = std::move(cb); }
 
-    /** Fixed palette for lane envelope colours (index 0..kMaxEnvelopeLanes-1). Shared with overlay and web UI. */
+    /** Fixed 8-colour palette for lane envelope colours, repeating for lanes 9 and up. Shared with overlay and web UI. */
     static juce::Colour getLaneColour(int laneIndex);
 
 private:
-    // Audio data storage - stores samples for one full measure
-    std::vector<float> measureBuffer;
-    std::array<std::vector<float>, kMaxEnvelopeLanes> envelopeMeasureBuffers;
-    int measureBufferWritePosition;
+    // Audio thread -> refresh(); everything below it is only touched on the message thread
+    ScopeFifo scopeFifo;
+
+    // Keeps prepare() from resizing the FIFO under a drain; the audio thread never takes it
+    juce::CriticalSection fifoCapacityLock;
+
+    // Latest prepare() settings, applied by the next refresh()
+    std::atomic<double> preparedSampleRate { 0.0 };
+    std::atomic<double> preparedMeasureSeconds { 0.0 };
+    std::atomic<bool> prepareRequested { false };
+
+    // Audio data storage - one full measure of decimated mono audio and of each lane's
+    // envelope (one point per ScopeDataSink::getSamplesPerPoint() samples), with min/max
+    // summaries kept up to date as points arrive. Starting a new measure just rewinds their
+    // lengths; anything past them is stale and reads as silence.
+    MinMaxPyramid measurePoints;
+    std::array<MinMaxPyramid, kMaxEnvelopeLanes> envelopeMeasures;
     int measureBufferCapacity;
     
     // Playhead tracking
@@ -63,13 +87,12 @@ private:
     double quarterNotesPerBar;
     double lastBPM;
     double lastSampleRate;
-    int samplesInCurrentMeasure;
+    int pointsInCurrentMeasure;
     bool hasValidPlayheadInfo;
     bool isNewMeasure;
     
     // Display settings
     float verticalZoom;
-    int refreshRateHz;
     
     // Visual settings
     juce::Colour backgroundColour;
@@ -79,24 +102,46 @@ private:
     bool showGrid;
     bool showEnvelope;
     
-    // Thread safety
-    juce::CriticalSection bufferLock;
-    
     // Display buffer for rendering
-    std::vector<float> displayBuffer;
+    std::vector<juce::Range<float>> displayBuffer;     // waveform min/max per pixel column
     std::array<std::vector<float>, kMaxEnvelopeLanes> envelopeDisplayBuffers;
+    std::array<std::vector<float>, kMaxEnvelopeLanes> smoothedEnvelopeBuffers;  // drawn or handed to the overlay
+    std::array<float, kMaxEnvelopeLanes> smoothedEnvelopePeaks {};
+    std::array<bool, kMaxEnvelopeLanes> envelopeLaneChanged {};
+    float envelopeDisplayPeak;                          // highest smoothed envelope value: sets the scale
     bool needsDisplayUpdate;
+    bool needsFullRepaint;
+
+    // Background, border, grid and centre line, rendered at the display's pixel scale.
+    // Rebuilt only after a resize, a time signature change or a visual setting change.
+    juce::Image staticLayer;
+    float staticLayerScale;
+
+    // Reused by paint() so steady-state repaints don't allocate
+    juce::RectangleList<float> waveformBand;
+    juce::Path envelopePath;
 
     EnvelopeOverlayCallback envelopeOverlayCallback;
     
+    // ScopeFifo::Reader: measure assembly, called from refresh()
+    void handlePlayhead(const juce::AudioPlayHead::CurrentPositionInfo& info) override;
+    void handleAudio(const float* minima, const float* maxima, int numPoints) override;
+    void handleEnvelope(const float* peaks, int numPoints, int laneIndex) override;
+    void handleOverflow() override;
+
     // Helper methods
-    void updateDisplayBuffer();
+    juce::Range<int> updateDisplayBuffer();             // returns the columns that changed
+    void repaintColumns(juce::Range<int> columns);
+    void invalidateStaticLayer();
+    void renderStaticLayer(float scale);
+    juce::Rectangle<int> getDisplayArea() const { return getLocalBounds().reduced(2); }
     void drawGrid(juce::Graphics& g, juce::Rectangle<int> bounds);
-    void drawWaveform(juce::Graphics& g, juce::Rectangle<int> bounds);
-    void drawEnvelope(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void drawWaveform(juce::Graphics& g, juce::Rectangle<int> bounds, juce::Range<int> columns);
+    void drawEnvelope(juce::Graphics& g, juce::Rectangle<int> bounds, juce::Range<int> columns);
     float getScaledSample(float sample, int height) const;
     double getPPQWithinMeasure(double ppq) const;
     void resetMeasureBuffer();
+    void applyPreparedSettings();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OsciloscopeComponent)
 };
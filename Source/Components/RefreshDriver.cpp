@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    RefreshDriver.cpp
+    One vblank-paced UI refresh per editor, throttled when idle, off when not visible
+
+  ==============================================================================
+*/
+
+#include "RefreshDriver.h"
+
+namespace
+{
+    // A tick due within this of the next vblank is taken now, so 30 Hz on a 60 Hz display
+    // is every other frame rather than drifting between two and three
+    constexpr double kTickToleranceSeconds = 0.004;
+}
+
+RefreshDriver::RefreshDriver(juce::Component& componentToWatch, double activeRateHz, double idleRateHz)
+    : component(componentToWatch),
+      activePeriod(1.0 / juce::jmax(1.0, activeRateHz)),
+      idlePeriod(1.0 / juce::jmax(1.0, idleRateHz)),
+      vblank(&componentToWatch, [this](double timestampSeconds) { onVBlank(timestampSeconds); })
+{
+}
+
+void RefreshDriver::addClient(Client* client)
+{
+    clients.addIfNotAlreadyThere(client);
+}
+
+void RefreshDriver::removeClient(Client* client)
+{
+    clients.removeFirstMatchingValue(client);
+}
+
+bool RefreshDriver::isComponentVisible() const
+{
+    // isShowing() is false for a minimised window or a hidden parent; the vblank itself
+    // only fires while the component is on a window
+    return component.isShowing() && !component.getLocalBounds().isEmpty();
+}
+
+void RefreshDriver::onVBlank(double timestampSeconds)
+{
+    if (clients.isEmpty() || !isComponentVisible())
+        return;
+
+    bool active = false;
+    for (auto* client : clients)
+        active = active || client->wantsActiveRate();
+
+    const double period = active ? activePeriod : idlePeriod;
+    if (timestampSeconds - lastTickSeconds < period - kTickToleranceSeconds)
+        return;
+
+    lastTickSeconds = timestampSeconds;
+    for (auto* client : clients)
+        client->refresh();
+}
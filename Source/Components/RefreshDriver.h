@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    RefreshDriver.h
+    One vblank-paced UI refresh per editor, throttled when idle, off when not visible
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Ticks its clients from the display's vblank instead of each component running its own
+// timer. Clients are refreshed at the active rate while any of them wants it (e.g. the
+// transport is playing) and at the idle rate otherwise. Nothing runs while the watched
+// component has no window, is minimised or hidden, or has zero size.
+class RefreshDriver
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        // Message thread, at most once per tick
+        virtual void refresh() = 0;
+
+        // True while the client has something moving to show
+        virtual bool wantsActiveRate() const { return false; }
+    };
+
+    static constexpr double defaultActiveRateHz = 30.0;
+    static constexpr double defaultIdleRateHz = 5.0;
+
+    explicit RefreshDriver(juce::Component& componentToWatch, double activeRateHz = defaultActiveRateHz,
+                           double idleRateHz = defaultIdleRateHz);
+    ~RefreshDriver() = default;
+
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+private:
+    juce::Component& component;
+    const double activePeriod;
+    const double idlePeriod;
+    double lastTickSeconds = 0.0;
+    juce::Array<Client*> clients;
+    juce::VBlankAttachment vblank;
+
+    void onVBlank(double timestampSeconds);
+    bool isComponentVisible() const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RefreshDriver)
+};
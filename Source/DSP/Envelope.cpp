@@ -18,91 +18,104 @@ void Envelope::prepare(double newSampleRate)
 {
     sampleRate = newSampleRate;
     calculateCoefficients();
-    float tau = static_cast<float>(kSmoothTimeSeconds * sampleRate);
-    smoothCoeff = (tau > 0.0f) ? (1.0f - std::exp(-1.0f / tau)) : 1.0f;
-    smoothCoeff = juce::jlimit(0.0001f, 1.0f, smoothCoeff);
+    smoother.prepare(sampleRate, kSmoothTimeSeconds);
     reset();
 }
 
 void Envelope::reset()
 {
-    phase = Phase::Idle;
+    beginSegment(Phase::Idle, 0.0f);
     currentValue = 0.0f;
     smoothedValue = 0.0f;
-    sampleCounter = 0;
 }
 
 void Envelope::trigger()
 {
-    phase = Phase::Attack;
-    sampleCounter = 0;
     // Don't reset currentValue - allows retriggering from current position
+    beginSegment(Phase::Attack, currentValue);
 }
 
 float Envelope::process()
 {
-    switch (phase)
-    {
-        case Phase::Idle:
-            currentValue = 0.0f;
-            break;
-
-        case Phase::Attack:
-            currentValue += attackIncrement;
-            sampleCounter++;
-            
-            if (currentValue >= 1.0f || sampleCounter >= attackSamples)
-            {
-                currentValue = 1.0f;
-                phase = Phase::Hold;
-                sampleCounter = 0;
-            }
-            break;
-
-        case Phase::Hold:
-            currentValue = 1.0f;
-            sampleCounter++;
-            
-            if (sampleCounter >= holdSamples)
-            {
-                phase = Phase::Decay;
-                sampleCounter = 0;
-            }
-            break;
+    float value;
+    process(&value, 1);
+    return value;
+}
 
-        case Phase::Decay:
-            currentValue -= decayDecrement;
-            sampleCounter++;
-            
-            if (currentValue <= 0.0f || sampleCounter >= decaySamples)
-            {
-                currentValue = 0.0f;
-                phase = Phase::Idle;
-                sampleCounter = 0;
-            }
-            break;
+void Envelope::process(float* output, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        if (phase == Phase::Idle)
+        {
+            smoother.render(output, numSamples, 0.0f, 0.0f, 0, smoothedValue);
+            return;
+        }
+
+        // Render the straight part of the segment in one go...
+        const int rampSamples = juce::jmin(numSamples, segmentLength - sampleCounter - 1);
+        if (rampSamples > 0)
+        {
+            smoother.render(output, rampSamples, segmentStart, segmentSlope, sampleCounter, smoothedValue);
+            sampleCounter += rampSamples;
+            currentValue = segmentStart + segmentSlope * static_cast<float>(sampleCounter);
+            output += rampSamples;
+            numSamples -= rampSamples;
+            continue;
+        }
+
+        // ...then land its final sample exactly on the target and move on: Attack -> Hold -> Decay -> Idle
+        currentValue = (phase == Phase::Decay) ? 0.0f : 1.0f;
+        smoother.render(output, 1, currentValue, 0.0f, 0, smoothedValue);
+        ++output;
+        --numSamples;
+
+        const auto nextPhase = (phase == Phase::Attack) ? Phase::Hold
+                             : (phase == Phase::Hold) ? Phase::Decay
+                             : Phase::Idle;
+        beginSegment(nextPhase, currentValue);
     }
-
-    smoothedValue += smoothCoeff * (currentValue - smoothedValue);
-    return smoothedValue;
 }
 
 void Envelope::setAttack(float attackTimeSeconds)
 {
-    attackTime = juce::jmax(0.001f, attackTimeSeconds);
-    calculateCoefficients();
+    setParameters(attackTimeSeconds, holdTime, decayTime);
 }
 
 void Envelope::setHold(float holdTimeSeconds)
 {
-    holdTime = juce::jmax(0.0f, holdTimeSeconds);
-    calculateCoefficients();
+    setParameters(attackTime, holdTimeSeconds, decayTime);
 }
 
 void Envelope::setDecay(float decayTimeSeconds)
 {
-    decayTime = juce::jmax(0.001f, decayTimeSeconds);
+    setParameters(attackTime, holdTime, decayTimeSeconds);
+}
+
+void Envelope::setParameters(float attackTimeSeconds, float holdTimeSeconds, float decayTimeSeconds)
+{
+    const float newAttack = juce::jmax(0.001f, attackTimeSeconds);
+    const float newHold = juce::jmax(0.0f, holdTimeSeconds);
+    const float newDecay = juce::jmax(0.001f, decayTimeSeconds);
+
+    if (newAttack == attackTime && newHold == holdTime && newDecay == decayTime)
+        return;
+
+    attackTime = newAttack;
+    holdTime = newHold;
+    decayTime = newDecay;
     calculateCoefficients();
+
+    // A running segment continues from where it is with the new timing
+    if (phase == Phase::Hold)
+    {
+        segmentLength = juce::jmax(1, holdSamples);
+        sampleCounter = juce::jmin(sampleCounter, segmentLength - 1);
+    }
+    else if (phase != Phase::Idle)
+    {
+        beginSegment(phase, currentValue);
+    }
 }
 
 void Envelope::calculateCoefficients()
@@ -120,3 +133,36 @@ void Envelope::calculateCoefficients()
     attackIncrement = 1.0f / static_cast<float>(attackSamples);
     decayDecrement = 1.0f / static_cast<float>(decaySamples);
 }
+
+void Envelope::beginSegment(Phase newPhase, float startValue)
+{
+    phase = newPhase;
+    sampleCounter = 0;
+    segmentStart = startValue;
+
+    // Lengths are measured from the start value, so a retrigger from halfway up takes half the attack
+    switch (newPhase)
+    {
+        case Phase::Idle:
+            segmentStart = 0.0f;
+            segmentSlope = 0.0f;
+            segmentLength = 0;
+            break;
+
+        case Phase::Attack:
+            segmentSlope = attackIncrement;
+            segmentLength = juce::jlimit(1, attackSamples, static_cast<int>(std::ceil((1.0 - startValue) * attackSamples)));
+            break;
+
+        case Phase::Hold:
+            segmentStart = 1.0f;
+            segmentSlope = 0.0f;
+            segmentLength = juce::jmax(1, holdSamples);
+            break;
+
+        case Phase::Decay:
+            segmentSlope = -decayDecrement;
+            segmentLength = juce::jlimit(1, decaySamples, static_cast<int>(std::ceil(static_cast<double>(startValue) * decaySamples)));
+            break;
+    }
+}
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SmoothedRamp.h"
 
 class Envelope
 {
@@ -34,16 +35,21 @@ public:
     // Process and return the current envelope value (0.0 to 1.0)
     float process();
 
+    // Process numSamples values into output (same as calling process() per sample, but each
+    // segment is rendered in closed form rather than one sample at a time)
+    void process(float* output, int numSamples);
+
     // Get current envelope value without advancing (smoothed output)
     float getCurrentValue() const { return smoothedValue; }
 
     // Check if envelope is active
     bool isActive() const { return phase != Phase::Idle; }
 
-    // Set envelope parameters (in seconds)
+    // Set envelope parameters (in seconds); coefficients are only recalculated on change
     void setAttack(float attackTimeSeconds);
     void setHold(float holdTimeSeconds);
     void setDecay(float decayTimeSeconds);
+    void setParameters(float attackTimeSeconds, float holdTimeSeconds, float decayTimeSeconds);
 
     // Get current phase
     Phase getPhase() const { return phase; }
@@ -55,8 +61,8 @@ private:
 
     // Smoothed output (one-pole lowpass)
     float smoothedValue = 0.0f;
-    float smoothCoeff = 0.0f;
-    
+    SmoothedRamp smoother;
+
     // Time parameters in seconds
     float attackTime = 0.01f;
     float holdTime = 0.1f;
@@ -72,9 +78,18 @@ private:
     float currentValue = 0.0f;
     int sampleCounter = 0;
 
+    // Current segment: value = segmentStart + segmentSlope * sampleCounter, ending (on exactly
+    // 1 or 0) at sampleCounter == segmentLength
+    float segmentStart = 0.0f;
+    float segmentSlope = 0.0f;
+    int segmentLength = 0;
+
     // Increment/decrement per sample
     float attackIncrement = 0.0f;
     float decayDecrement = 0.0f;
 
     void calculateCoefficients();
+
+    // Start newPhase from startValue, or restart the running segment with new coefficients
+    void beginSegment(Phase newPhase, float startValue);
 };
@@ -0,0 +1,302 @@
+/*
+  ==============================================================================
+
+    EnvelopeBank.cpp
+    Structure-of-arrays AHD envelopes for all lanes, advanced together
+
+  ==============================================================================
+*/
+
+#include "EnvelopeBank.h"
+#include "../EnvGenConfig.h"
+
+template <int NumLanes>
+EnvelopeBank<NumLanes>::EnvelopeBank()
+{
+    static_assert(decayPhase == 3 && idlePhase == 0, "Phase advance relies on Idle/Attack/Hold/Decay = 0..3");
+
+    // Padding lanes get valid coefficients too, so the vector code never sees garbage
+    for (int lane = 0; lane < numPaddedLanes; ++lane)
+    {
+        attackTime[lane] = 0.01f;
+        holdTime[lane] = 0.1f;
+        decayTime[lane] = 0.5f;
+        calculateCoefficients(lane);
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    for (int lane = 0; lane < numPaddedLanes; ++lane)
+        calculateCoefficients(lane);
+
+    smoother.prepare(sampleRate, kSmoothTimeSeconds);
+    reset();
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::reset()
+{
+    for (int lane = 0; lane < numPaddedLanes; ++lane)
+    {
+        phase[lane] = idlePhase;
+        sampleCounter[lane] = 0;
+        segmentLength[lane] = 0;
+        segmentStart[lane] = 0.0f;
+        segmentSlope[lane] = 0.0f;
+        currentValue[lane] = 0.0f;
+        smoothedValue[lane] = 0.0f;
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::trigger(juce::uint32 laneMask)
+{
+    // Don't reset currentValue - allows retriggering from current position
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+        if (((laneMask >> lane) & 1u) != 0)
+            beginRamp(lane, attackPhase);
+}
+
+namespace
+{
+    template <typename Vec, typename Mask>
+    Vec select(Mask mask, Vec ifTrue, Vec ifFalse)
+    {
+        return (ifTrue & mask) + (ifFalse & ~mask);
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::process(float* const* outputs, int numSamples, juce::uint32 laneMask)
+{
+    // A silent lane is Idle with its smoother at exactly 0, so skipping it leaves its state unchanged
+    jassert((getActiveMask() & ~laneMask) == 0);
+
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        const int span = juce::jmin(numSamples - position, kSpanSamples, getSamplesUntilPhaseChange());
+        renderSpan(span, laneMask);
+
+        for (int lane = 0; lane < NUM_LANES; ++lane)
+        {
+            if (((laneMask >> lane) & 1u) == 0)
+                continue;
+
+            float* output = outputs[lane] + position;
+            for (int i = 0; i < span; ++i)
+                output[i] = spanBuffer[i * numPaddedLanes + lane];
+        }
+
+        advancePhases();
+        position += span;
+    }
+}
+
+template <int NumLanes>
+juce::uint32 EnvelopeBank<NumLanes>::getActiveMask() const
+{
+    juce::uint32 mask = 0;
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+        if (phase[lane] != idlePhase || smoothedValue[lane] != 0.0f)
+            mask |= juce::uint32(1) << lane;
+    return mask;
+}
+
+template <int NumLanes>
+int EnvelopeBank<NumLanes>::getSamplesUntilPhaseChange() const
+{
+    auto nearest = IntVec::expand(std::numeric_limits<int32_t>::max());
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        const int first = v * vectorSize;
+        const auto inIdle = IntVec::equal(IntVec::fromRawArray(phase + first), IntVec::expand(idlePhase));
+        const auto remaining = IntVec::fromRawArray(segmentLength + first) - IntVec::fromRawArray(sampleCounter + first);
+        nearest = IntVec::min(nearest, select(inIdle, nearest, remaining));
+    }
+
+    alignas(vectorAlignment) int32_t lanes[vectorSize];
+    nearest.copyToRawArray(lanes);
+    return *std::min_element(lanes, lanes + vectorSize);
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::renderSpan(int numSamples, juce::uint32 laneMask)
+{
+    jassert(numSamples > 0 && numSamples <= kSpanSamples);
+
+    const auto zero = FloatVec::expand(0.0f);
+    const auto one = FloatVec::expand(1.0f);
+    const auto settle = FloatVec::expand(SmoothedRamp::kSettleThreshold);
+    const auto spanLength = IntVec::expand(numSamples);
+    const float lagPerSlope = smoother.getLagPerSlope();
+    const float landingPower = smoother.getDecayPower(1);
+
+    // SIMDRegister has no int -> float conversion, so the segment positions go through an array
+    alignas(vectorAlignment) float counterValue[numPaddedLanes];
+    for (int lane = 0; lane < numPaddedLanes; ++lane)
+        counterValue[lane] = static_cast<float>(sampleCounter[lane]);
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        const int first = v * vectorSize;
+        if (((laneMask >> first) & vectorLaneBits) == 0)
+            continue;
+
+        const auto lanePhase = IntVec::fromRawArray(phase + first);
+        const auto counter = IntVec::fromRawArray(sampleCounter + first);
+        const auto start = FloatVec::fromRawArray(segmentStart + first);
+        const auto slope = FloatVec::fromRawArray(segmentSlope + first);
+        const auto position = FloatVec::fromRawArray(counterValue + first);
+        auto smoothed = FloatVec::fromRawArray(smoothedValue + first);
+
+        // Spans never cross a phase change, so at most the last sample ends a segment: on 0
+        // for decay, on 1 otherwise. Idle lanes are a flat 0 (start and slope are cleared).
+        const auto running = ~IntVec::equal(lanePhase, IntVec::expand(idlePhase));
+        const auto ends = running & IntVec::equal(IntVec::fromRawArray(segmentLength + first) - counter, spanLength);
+        const auto target = select(IntVec::equal(lanePhase, IntVec::expand(decayPhase)), zero, one);
+
+        // SmoothedRamp::render() for a register of lanes: the lagging ramp plus the transient
+        // left over from the smoother's current value
+        const auto lag = slope * lagPerSlope;
+        const auto offset = start - lag;
+        auto excess = smoothed - (start + slope * position) + lag;
+        excess = excess & (FloatVec::greaterThanOrEqual(excess, settle) | FloatVec::lessThanOrEqual(excess, zero - settle));
+
+        float* output = spanBuffer + first;
+        for (int i = 1; i < numSamples; ++i)
+        {
+            smoothed = offset + slope * (position + static_cast<float>(i)) + excess * smoother.getDecayPower(i);
+            smoothed.copyToRawArray(output);
+            output += numPaddedLanes;
+        }
+
+        // Last sample: a lane whose segment ends lands on its target, smoothed from the sample before
+        const auto endValue = start + slope * (position + static_cast<float>(numSamples));
+        const auto ramp = offset + slope * (position + static_cast<float>(numSamples)) + excess * smoother.getDecayPower(numSamples);
+        auto landingExcess = smoothed - target;
+        landingExcess = landingExcess & (FloatVec::greaterThanOrEqual(landingExcess, settle) | FloatVec::lessThanOrEqual(landingExcess, zero - settle));
+        smoothed = select(ends, target + landingExcess * landingPower, ramp);
+        smoothed.copyToRawArray(output);
+        smoothed.copyToRawArray(smoothedValue + first);
+
+        (counter + (spanLength & running)).copyToRawArray(sampleCounter + first);
+        select(running, select(ends, target, endValue), FloatVec::fromRawArray(currentValue + first)).copyToRawArray(currentValue + first);
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::advancePhases()
+{
+    const auto one = FloatVec::expand(1.0f);
+    const auto zero = FloatVec::expand(0.0f);
+    const auto intOne = IntVec::expand(1);
+    const auto phaseWrap = IntVec::vMaskType::expand(3);
+
+    for (int v = 0; v < numVectors; ++v)
+    {
+        const int first = v * vectorSize;
+
+        auto lanePhase = IntVec::fromRawArray(phase + first);
+        auto counter = IntVec::fromRawArray(sampleCounter + first);
+        auto length = IntVec::fromRawArray(segmentLength + first);
+        auto start = FloatVec::fromRawArray(segmentStart + first);
+        auto slope = FloatVec::fromRawArray(segmentSlope + first);
+
+        const auto decayStep = FloatVec::fromRawArray(decayDecrement + first);
+        const auto holdLength = IntVec::max(IntVec::fromRawArray(holdSamples + first), intOne);
+        const auto decayLength = IntVec::fromRawArray(decaySamples + first);
+
+        // Attack -> Hold -> Decay -> Idle for every lane that reached the end of its segment
+        const auto ended = ~IntVec::equal(lanePhase, IntVec::expand(idlePhase)) & IntVec::greaterThanOrEqual(counter, length);
+        lanePhase = (lanePhase + (intOne & ended)) & phaseWrap;
+
+        const auto toHold = ended & IntVec::equal(lanePhase, IntVec::expand(holdPhase));
+        const auto toDecay = ended & IntVec::equal(lanePhase, IntVec::expand(decayPhase));
+
+        // Hold sits at 1 and decay falls from it; a lane that went idle is all zero
+        start = select(toHold | toDecay, one, start & ~ended);
+        slope = select(toDecay, zero - decayStep, slope & ~ended);
+        length = select(toHold, holdLength, select(toDecay, decayLength, length & ~ended));
+        counter = counter & ~ended;
+
+        lanePhase.copyToRawArray(phase + first);
+        counter.copyToRawArray(sampleCounter + first);
+        length.copyToRawArray(segmentLength + first);
+        start.copyToRawArray(segmentStart + first);
+        slope.copyToRawArray(segmentSlope + first);
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::beginRamp(int laneIndex, int newPhase)
+{
+    const float startValue = currentValue[laneIndex];
+
+    phase[laneIndex] = newPhase;
+    sampleCounter[laneIndex] = 0;
+    segmentStart[laneIndex] = startValue;
+
+    // Same lengths as Envelope::beginSegment(): measured from the start value
+    if (newPhase == attackPhase)
+    {
+        segmentSlope[laneIndex] = attackIncrement[laneIndex];
+        segmentLength[laneIndex] = juce::jlimit(1, attackSamples[laneIndex],
+                                                static_cast<int>(std::ceil((1.0 - startValue) * attackSamples[laneIndex])));
+    }
+    else
+    {
+        segmentSlope[laneIndex] = -decayDecrement[laneIndex];
+        segmentLength[laneIndex] = juce::jlimit(1, decaySamples[laneIndex],
+                                                static_cast<int>(std::ceil(static_cast<double>(startValue) * decaySamples[laneIndex])));
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::setParameters(int laneIndex, float attackTimeSeconds, float holdTimeSeconds, float decayTimeSeconds)
+{
+    if (laneIndex < 0 || laneIndex >= NUM_LANES)
+        return;
+
+    const float newAttack = juce::jmax(0.001f, attackTimeSeconds);
+    const float newHold = juce::jmax(0.0f, holdTimeSeconds);
+    const float newDecay = juce::jmax(0.001f, decayTimeSeconds);
+
+    if (newAttack == attackTime[laneIndex] && newHold == holdTime[laneIndex] && newDecay == decayTime[laneIndex])
+        return;
+
+    attackTime[laneIndex] = newAttack;
+    holdTime[laneIndex] = newHold;
+    decayTime[laneIndex] = newDecay;
+    calculateCoefficients(laneIndex);
+
+    // A running segment continues from where it is with the new timing
+    if (phase[laneIndex] == holdPhase)
+    {
+        segmentLength[laneIndex] = juce::jmax(1, holdSamples[laneIndex]);
+        sampleCounter[laneIndex] = juce::jmin(sampleCounter[laneIndex], segmentLength[laneIndex] - 1);
+    }
+    else if (phase[laneIndex] != idlePhase)
+    {
+        beginRamp(laneIndex, phase[laneIndex]);
+    }
+}
+
+template <int NumLanes>
+void EnvelopeBank<NumLanes>::calculateCoefficients(int laneIndex)
+{
+    // Same sample counts and linear increments as Envelope::calculateCoefficients()
+    attackSamples[laneIndex] = juce::jmax(1, static_cast<int>(attackTime[laneIndex] * sampleRate));
+    holdSamples[laneIndex] = static_cast<int>(holdTime[laneIndex] * sampleRate);
+    decaySamples[laneIndex] = juce::jmax(1, static_cast<int>(decayTime[laneIndex] * sampleRate));
+
+    attackIncrement[laneIndex] = 1.0f / static_cast<float>(attackSamples[laneIndex]);
+    decayDecrement[laneIndex] = 1.0f / static_cast<float>(decaySamples[laneIndex]);
+}
+
+template class EnvelopeBank<EnvGenConfig::numLanes>;
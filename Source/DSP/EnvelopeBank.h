@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    EnvelopeBank.h
+    Structure-of-arrays AHD envelopes for all lanes, advanced together
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Envelope.h"
+#include "SmoothedRamp.h"
+
+// Same behaviour as NUM_LANES independent Envelope objects, but with every piece of state
+// stored as a lane-wide array. A block is cut into spans at the samples where any lane
+// changes phase; inside a span each lane is a straight segment, and the phase transitions at
+// the span edges are selected for all lanes at once with juce::dsp::SIMDRegister comparison
+// masks instead of a switch.
+//
+// Sample values are rendered across lanes too: each span evaluates SmoothedRamp's closed form
+// (ramp plus decaying transient) for a whole register of lanes per sample into a
+// lane-interleaved scratch buffer, which is then copied out to each lane's own output.
+// Registers with no lane in the process() mask are skipped. Source/Tests/EnvelopeBankTest.cpp
+// checks the output against independent Envelope objects and a per-sample reference.
+//
+// Templated on the lane count (instantiated in EnvelopeBank.cpp for the build's
+// ENVGEN_NUM_LANES). Storage is padded to whole SIMD registers; padding lanes stay idle.
+template <int NumLanes>
+class EnvelopeBank
+{
+public:
+    static constexpr int NUM_LANES = NumLanes;
+    static_assert(NUM_LANES >= 1 && NUM_LANES <= 32, "Lanes are addressed through a 32-bit trigger mask");
+
+    using FloatVec = juce::dsp::SIMDRegister<float>;
+    using IntVec = juce::dsp::SIMDRegister<int32_t>;
+    using MaskVec = FloatVec::vMaskType;
+
+    EnvelopeBank();
+    ~EnvelopeBank() = default;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Trigger the envelopes of every lane whose bit is set, from the beginning
+    void trigger(juce::uint32 laneMask);
+
+    // Bit n set for every lane
+    static constexpr juce::uint32 allLanes = (NUM_LANES == 32) ? ~juce::uint32(0) : (juce::uint32(1) << NUM_LANES) - 1;
+
+    // Advance all lanes by numSamples; lane n's output (0.0 to 1.0) goes to outputs[n].
+    // Lanes outside laneMask must be silent (see getActiveMask()); their outputs are not written.
+    void process(float* const* outputs, int numSamples, juce::uint32 laneMask = allLanes);
+
+    // Set envelope parameters (in seconds); coefficients are only recalculated on change
+    void setParameters(int laneIndex, float attackTimeSeconds, float holdTimeSeconds, float decayTimeSeconds);
+
+    // Get current envelope value without advancing (smoothed output)
+    float getCurrentValue(int laneIndex) const { return smoothedValue[laneIndex]; }
+
+    // Check if envelope is active
+    bool isActive(int laneIndex) const { return phase[laneIndex] != idlePhase; }
+
+    // Lanes that are active or whose smoothed output has not yet settled to exactly 0
+    juce::uint32 getActiveMask() const;
+
+    Envelope::Phase getPhase(int laneIndex) const { return static_cast<Envelope::Phase>(phase[laneIndex]); }
+
+private:
+    static constexpr float kSmoothTimeSeconds = 0.002f;  // 2 ms one-pole smoothing
+
+    // Phase values match Envelope::Phase; Decay + 1 wraps to Idle
+    static constexpr int idlePhase = static_cast<int>(Envelope::Phase::Idle);
+    static constexpr int attackPhase = static_cast<int>(Envelope::Phase::Attack);
+    static constexpr int holdPhase = static_cast<int>(Envelope::Phase::Hold);
+    static constexpr int decayPhase = static_cast<int>(Envelope::Phase::Decay);
+
+    static constexpr int vectorSize = static_cast<int>(FloatVec::SIMDNumElements);
+    static constexpr int numVectors = (NUM_LANES + vectorSize - 1) / vectorSize;
+    static constexpr int numPaddedLanes = numVectors * vectorSize;
+    static constexpr size_t vectorAlignment = FloatVec::SIMDRegisterSize;
+    static constexpr juce::uint32 vectorLaneBits = (juce::uint32(1) << vectorSize) - 1;
+
+    // Longest span rendered at once; longer ones are cut, which the closed form doesn't notice
+    static constexpr int kSpanSamples = 64;
+
+    double sampleRate = 44100.0;
+    SmoothedRamp smoother;
+
+    // Per-lane state; the running segment is segmentStart + segmentSlope * sampleCounter,
+    // ending (on exactly 1 or 0) at sampleCounter == segmentLength
+    alignas(vectorAlignment) int32_t phase[numPaddedLanes] = {};
+    alignas(vectorAlignment) int32_t sampleCounter[numPaddedLanes] = {};
+    alignas(vectorAlignment) int32_t segmentLength[numPaddedLanes] = {};
+    alignas(vectorAlignment) float segmentStart[numPaddedLanes] = {};
+    alignas(vectorAlignment) float segmentSlope[numPaddedLanes] = {};
+    alignas(vectorAlignment) float currentValue[numPaddedLanes] = {};
+    alignas(vectorAlignment) float smoothedValue[numPaddedLanes] = {};
+
+    // Per-lane coefficients
+    alignas(vectorAlignment) int32_t attackSamples[numPaddedLanes] = {};
+    alignas(vectorAlignment) int32_t holdSamples[numPaddedLanes] = {};
+    alignas(vectorAlignment) int32_t decaySamples[numPaddedLanes] = {};
+    alignas(vectorAlignment) float attackIncrement[numPaddedLanes] = {};
+    alignas(vectorAlignment) float decayDecrement[numPaddedLanes] = {};
+
+    // Output of the last renderSpan(): sample i of lane n at [i * numPaddedLanes + n]
+    alignas(vectorAlignment) float spanBuffer[kSpanSamples * numPaddedLanes] = {};
+
+    // Time parameters in seconds
+    float attackTime[numPaddedLanes];
+    float holdTime[numPaddedLanes];
+    float decayTime[numPaddedLanes];
+
+    void calculateCoefficients(int laneIndex);
+
+    // Samples until the next phase change of any lane, counting the sample it happens on
+    int getSamplesUntilPhaseChange() const;
+
+    // Render numSamples (at most kSpanSamples, not crossing a phase change) of every lane in
+    // laneMask into spanBuffer, one sample of all lanes after another
+    void renderSpan(int numSamples, juce::uint32 laneMask);
+
+    // Move every lane whose segment has ended on to its next phase
+    void advancePhases();
+
+    // Restart a lane's attack or decay from its current value with the current coefficients
+    void beginRamp(int laneIndex, int newPhase);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EnvelopeBank)
+};
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    LaneRenderer.cpp
+    Block renderer for the sequencer/envelope lanes
+
+  ==============================================================================
+*/
+
+#include "LaneRenderer.h"
+#include "../EnvGenConfig.h"
+
+template <int NumLanes, int NumSteps>
+void LaneRenderer<NumLanes, NumSteps>::prepare(double sampleRate, int maxBlockSize)
+{
+    envelopes.prepare(sampleRate);
+    for (int i = 0; i < NUM_LANES; ++i)
+        sequencers[i].prepare(sampleRate);
+
+    laneBuffers.setSize(NUM_LANES, juce::jmax(1, maxBlockSize));
+    laneBuffers.clear();
+    modulationBuffer.assign(static_cast<size_t>(juce::jmax(1, maxBlockSize)), 0.0f);
+    stepEvents.resize(static_cast<size_t>(juce::jmax(1, maxBlockSize)));
+    triggerMasks.assign(static_cast<size_t>(juce::jmax(1, maxBlockSize)), 0);
+    triggerOffsets.resize(static_cast<size_t>(juce::jmax(1, maxBlockSize)));
+
+    silentLaneBuffers = Envelopes::allLanes;
+    modulationIsSilent = true;
+    activeLanes = 0;
+    modulatedLanes = 0;
+}
+
+template <int NumLanes, int NumSteps>
+void LaneRenderer<NumLanes, NumSteps>::reset()
+{
+    envelopes.reset();
+    for (int i = 0; i < NUM_LANES; ++i)
+        sequencers[i].reset();
+}
+
+template <int NumLanes, int NumSteps>
+void LaneRenderer<NumLanes, NumSteps>::process(const juce::AudioPlayHead::PositionInfo& positionInfo,
+                                               int numActiveLanes, const float* laneAmounts, int numSamples)
+{
+    jassert(numSamples <= laneBuffers.getNumSamples());
+    numSamples = juce::jmin(numSamples, laneBuffers.getNumSamples());
+    numActiveLanes = juce::jlimit(0, NUM_LANES, numActiveLanes);
+
+    // Gather the sample-accurate triggers of every active lane, keyed by sample offset
+    int numTriggerOffsets = 0;
+    triggeredLanes = 0;
+    for (int lane = 0; lane < numActiveLanes; ++lane)
+        numTriggerOffsets = scheduleLane(lane, positionInfo, numSamples, numTriggerOffsets);
+
+    std::sort(triggerOffsets.begin(), triggerOffsets.begin() + numTriggerOffsets);
+
+    // Only lanes that are running, settling or about to fire can produce anything this block;
+    // the others are silent, and their buffers only need clearing once
+    activeLanes = envelopes.getActiveMask() | triggeredLanes;
+
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+        if ((((activeLanes | silentLaneBuffers) >> lane) & 1u) == 0)
+            laneBuffers.clear(lane, 0, laneBuffers.getNumSamples());
+    silentLaneBuffers = Envelopes::allLanes & ~activeLanes;
+
+    // Advance all envelopes together, in spans between trigger offsets
+    float* outputs[NUM_LANES];
+    int position = 0;
+
+    for (int i = 0; i <= numTriggerOffsets; ++i)
+    {
+        const int spanEnd = (i < numTriggerOffsets) ? triggerOffsets[static_cast<size_t>(i)] : numSamples;
+
+        for (int lane = 0; lane < NUM_LANES; ++lane)
+            outputs[lane] = laneBuffers.getWritePointer(lane, position);
+        if (activeLanes != 0)
+            envelopes.process(outputs, spanEnd - position, activeLanes);
+        position = spanEnd;
+
+        if (i < numTriggerOffsets)
+        {
+            auto& mask = triggerMasks[static_cast<size_t>(spanEnd)];
+            envelopes.trigger(mask);
+            mask = 0;
+        }
+    }
+
+    // Sum into the modulation buffer only the lanes that contribute
+    modulatedLanes = 0;
+    for (int lane = 0; lane < numActiveLanes; ++lane)
+        if (laneAmounts[lane] != 0.0f)
+            modulatedLanes |= (activeLanes & (juce::uint32(1) << lane));
+
+    float* modulation = modulationBuffer.data();
+    if (modulatedLanes == 0)
+    {
+        if (!modulationIsSilent)
+            juce::FloatVectorOperations::clear(modulation, static_cast<int>(modulationBuffer.size()));
+        modulationIsSilent = true;
+        return;
+    }
+
+    juce::FloatVectorOperations::clear(modulation, numSamples);
+    modulationIsSilent = false;
+
+    for (int lane = 0; lane < numActiveLanes; ++lane)
+        if (((modulatedLanes >> lane) & 1u) != 0)
+            juce::FloatVectorOperations::addWithMultiply(modulation, laneBuffers.getReadPointer(lane),
+                                                         laneAmounts[lane], numSamples);
+}
+
+template <int NumLanes, int NumSteps>
+int LaneRenderer<NumLanes, NumSteps>::scheduleLane(int laneIndex, const juce::AudioPlayHead::PositionInfo& positionInfo,
+                                                   int numSamples, int numTriggerOffsets)
+{
+    const int numEvents = sequencers[laneIndex].scheduleBlock(positionInfo, numSamples, stepEvents.data());
+    const auto laneBit = juce::uint32(1) << laneIndex;
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        const auto& event = stepEvents[static_cast<size_t>(i)];
+        if (!event.trigger)
+            continue;
+
+        auto& mask = triggerMasks[static_cast<size_t>(event.sampleOffset)];
+        if (mask == 0)
+            triggerOffsets[static_cast<size_t>(numTriggerOffsets++)] = event.sampleOffset;
+        mask |= laneBit;
+        triggeredLanes |= laneBit;
+    }
+
+    return numTriggerOffsets;
+}
+
+template class LaneRenderer<EnvGenConfig::numLanes, EnvGenConfig::numSteps>;
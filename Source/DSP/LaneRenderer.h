@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    LaneRenderer.h
+    Block renderer for the sequencer/envelope lanes
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EnvelopeBank.h"
+#include "StepSequencer.h"
+
+// Templated on lane and step counts; instantiated in LaneRenderer.cpp for the build's
+// ENVGEN_NUM_LANES / ENVGEN_NUM_STEPS
+template <int NumLanes, int NumSteps>
+class LaneRenderer
+{
+public:
+    static constexpr int NUM_LANES = NumLanes;
+    static constexpr int NUM_STEPS = NumSteps;
+
+    using Envelopes = EnvelopeBank<NumLanes>;
+    using Sequencer = StepSequencer<NumSteps>;
+
+    LaneRenderer() = default;
+    ~LaneRenderer() = default;
+
+    // Allocates the per-lane and modulation buffers (not real-time safe)
+    void prepare(double sampleRate, int maxBlockSize);
+    void reset();
+
+    // Render numActiveLanes lanes for a whole block. Each lane's envelope is written
+    // to its own contiguous buffer; lanes with a non-zero entry in laneAmounts are
+    // summed (scaled by that amount) into the modulation buffer. Only lanes that are
+    // running, settling or triggered in this block are rendered; the rest are silent.
+    void process(const juce::AudioPlayHead::PositionInfo& positionInfo,
+                 int numActiveLanes, const float* laneAmounts, int numSamples);
+
+    // Lanes that were rendered by the last process() call (all others output 0)
+    juce::uint32 getActiveLanes() const { return activeLanes; }
+
+    // Lanes that contributed to the modulation buffer in the last process() call;
+    // 0 means the modulation buffer is all zero
+    juce::uint32 getModulatedLanes() const { return modulatedLanes; }
+
+    // Per-lane envelope output of the last process() call (0.0 to 1.0)
+    const float* getLaneBuffer(int laneIndex) const { return laneBuffers.getReadPointer(laneIndex); }
+
+    // Summed amplitude modulation of the last process() call
+    float* getModulationBuffer() { return modulationBuffer.data(); }
+    const float* getModulationBuffer() const { return modulationBuffer.data(); }
+
+    Envelopes& getEnvelopes() { return envelopes; }
+    const Envelopes& getEnvelopes() const { return envelopes; }
+    Sequencer& getSequencer(int laneIndex) { return sequencers[laneIndex]; }
+    const Sequencer& getSequencer(int laneIndex) const { return sequencers[laneIndex]; }
+
+private:
+    Envelopes envelopes;
+    Sequencer sequencers[NUM_LANES];
+
+    juce::AudioBuffer<float> laneBuffers;
+    std::vector<float> modulationBuffer;
+
+    // Scratch for one block's triggers: lane bits per sample offset, and the offsets in use
+    std::vector<typename Sequencer::StepEvent> stepEvents;
+    std::vector<juce::uint32> triggerMasks;
+    std::vector<int> triggerOffsets;
+    juce::uint32 triggeredLanes = 0;
+
+    // Activity of the last block, and which buffers are already known to be all zero
+    juce::uint32 activeLanes = 0;
+    juce::uint32 modulatedLanes = 0;
+    juce::uint32 silentLaneBuffers = 0;
+    bool modulationIsSilent = false;
+
+    int scheduleLane(int laneIndex, const juce::AudioPlayHead::PositionInfo& positionInfo,
+                     int numSamples, int numTriggerOffsets);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LaneRenderer)
+};
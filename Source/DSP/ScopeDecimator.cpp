@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    ScopeDecimator.cpp
+    Min/max decimation of scope data on the audio thread
+
+  ==============================================================================
+*/
+
+#include "ScopeDecimator.h"
+
+void ScopeDecimator::prepare(int newSamplesPerPoint, int maxBlockSize)
+{
+    samplesPerPoint = juce::jmax(1, newSamplesPerPoint);
+
+    // A block can finish the group left over from the previous one plus one more per samplesPerPoint
+    const auto capacity = static_cast<size_t>(juce::jmax(1, maxBlockSize) / samplesPerPoint + 2);
+    minima.assign(capacity, 0.0f);
+    maxima.assign(capacity, 0.0f);
+
+    reset();
+}
+
+void ScopeDecimator::reset()
+{
+    samplesInGroup = 0;
+    numPoints = 0;
+}
+
+void ScopeDecimator::process(const float* samples, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const int numToTake = juce::jmin(numSamples, samplesPerPoint - samplesInGroup);
+        const auto range = juce::FloatVectorOperations::findMinAndMax(samples, numToTake);
+        addToGroup(range.getStart(), range.getEnd(), numToTake);
+
+        samples += numToTake;
+        numSamples -= numToTake;
+    }
+}
+
+void ScopeDecimator::processSilence(int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const int numToTake = juce::jmin(numSamples, samplesPerPoint - samplesInGroup);
+        addToGroup(0.0f, 0.0f, numToTake);
+        numSamples -= numToTake;
+    }
+}
+
+void ScopeDecimator::addToGroup(float lowest, float highest, int numSamples)
+{
+    groupMin = (samplesInGroup == 0) ? lowest : juce::jmin(groupMin, lowest);
+    groupMax = (samplesInGroup == 0) ? highest : juce::jmax(groupMax, highest);
+    samplesInGroup += numSamples;
+
+    if (samplesInGroup < samplesPerPoint)
+        return;
+
+    if (numPoints < static_cast<int>(minima.size()))
+    {
+        minima[static_cast<size_t>(numPoints)] = groupMin;
+        maxima[static_cast<size_t>(numPoints)] = groupMax;
+        ++numPoints;
+    }
+    samplesInGroup = 0;
+}
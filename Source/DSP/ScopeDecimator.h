@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    ScopeDecimator.h
+    Min/max decimation of scope data on the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Reduces a stream to one min/max point per samplesPerPoint samples. Groups carry over
+// between calls, so blocks of any size (and chunks of blocks) can be fed in; each group is
+// reduced with a single vectorised min/max scan. Completed points collect in fixed arrays
+// until clearPoints(); decimators fed the same sample counts stay in step point for point.
+class ScopeDecimator
+{
+public:
+    ScopeDecimator() = default;
+    ~ScopeDecimator() = default;
+
+    // Allocates room for the points of one maxBlockSize block (not real-time safe)
+    void prepare(int newSamplesPerPoint, int maxBlockSize);
+    void reset();
+
+    void process(const float* samples, int numSamples);
+    void processSilence(int numSamples);
+
+    // Points completed since the last clearPoints() (any beyond the prepared room are dropped)
+    int getNumPoints() const { return numPoints; }
+    const float* getMinima() const { return minima.data(); }
+    const float* getMaxima() const { return maxima.data(); }
+    void clearPoints() { numPoints = 0; }
+
+    int getSamplesPerPoint() const { return samplesPerPoint; }
+
+private:
+    int samplesPerPoint = 1;
+    int samplesInGroup = 0;
+    float groupMin = 0.0f;
+    float groupMax = 0.0f;
+
+    std::vector<float> minima;
+    std::vector<float> maxima;
+    int numPoints = 0;
+
+    void addToGroup(float lowest, float highest, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeDecimator)
+};
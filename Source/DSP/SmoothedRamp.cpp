@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    SmoothedRamp.cpp
+    Closed-form one-pole smoothing of linear envelope segments
+
+  ==============================================================================
+*/
+
+#include "SmoothedRamp.h"
+
+void SmoothedRamp::prepare(double sampleRate, float smoothTimeSeconds)
+{
+    float tau = static_cast<float>(smoothTimeSeconds * sampleRate);
+    coeff = (tau > 0.0f) ? (1.0f - std::exp(-1.0f / tau)) : 1.0f;
+    coeff = juce::jlimit(0.0001f, 1.0f, coeff);
+
+    const double r = 1.0 - static_cast<double>(coeff);
+    lagPerSlope = static_cast<float>(r / static_cast<double>(coeff));
+
+    // The transient never starts larger than 2 (a full-scale step plus a full-scale ramp lag),
+    // so the table stops where 2 * r^k is below the settle threshold
+    decayPowers.assign(1, 1.0f);
+    double power = 1.0;
+    while ((power *= r) * 2.0 >= static_cast<double>(kSettleThreshold))
+        decayPowers.push_back(static_cast<float>(power));
+}
+
+void SmoothedRamp::render(float* output, int numSamples, float start, float slope, int counter, float& smoothed) const
+{
+    if (numSamples <= 0)
+        return;
+
+    // Values are evaluated from the segment index, never accumulated, so long segments can't drift
+    const float lag = slope * lagPerSlope;
+    const float excess = smoothed - (start + slope * static_cast<float>(counter)) + lag;
+
+    if (slope == 0.0f)
+    {
+        juce::FloatVectorOperations::fill(output, start, numSamples);
+    }
+    else
+    {
+        const float offset = start - lag;
+        for (int i = 0; i < numSamples; ++i)
+            output[i] = offset + slope * static_cast<float>(counter + 1 + i);
+    }
+
+    if (std::abs(excess) >= kSettleThreshold)
+    {
+        const int transientSamples = juce::jmin(numSamples, static_cast<int>(decayPowers.size()) - 1);
+        juce::FloatVectorOperations::addWithMultiply(output, decayPowers.data() + 1, excess, transientSamples);
+    }
+
+    smoothed = output[numSamples - 1];
+}
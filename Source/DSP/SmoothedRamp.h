@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    SmoothedRamp.h
+    Closed-form one-pole smoothing of linear envelope segments
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Every AHD segment is a straight line x[k] = start + slope * k, and the output smoother is
+// the one-pole s[k] = s[k-1] + c * (x[k] - s[k-1]). Fed a ramp, the smoother has the exact
+// solution
+//
+//     s[k] = x[k] - slope * lag + excess * r^k,    r = 1 - c,  lag = r / c
+//
+// so a whole span can be written without a loop-carried dependency: a linear ramp plus a
+// decaying transient read from a table of r^k. Once the transient is below the settle
+// threshold it is dropped entirely, which makes held and idle spans a plain fill.
+class SmoothedRamp
+{
+public:
+    SmoothedRamp() = default;
+    ~SmoothedRamp() = default;
+
+    void prepare(double sampleRate, float smoothTimeSeconds);
+
+    // Write numSamples smoothed values of the segment start + slope * k for
+    // k = counter + 1 ... counter + numSamples, and advance smoothed to the last of them
+    void render(float* output, int numSamples, float start, float slope, int counter, float& smoothed) const;
+
+    float getCoefficient() const { return coeff; }
+
+    // The pieces of render() for callers that evaluate several segments side by side: the
+    // ramp lags its segment by slope * getLagPerSlope(), the transient is excess * r^k (zero
+    // past the table) and is dropped whole while |excess| is below kSettleThreshold
+    float getLagPerSlope() const { return lagPerSlope; }
+    float getDecayPower(int k) const { return k < static_cast<int>(decayPowers.size()) ? decayPowers[static_cast<size_t>(k)] : 0.0f; }
+
+    static constexpr float kSettleThreshold = 1.0e-6f;
+
+private:
+
+    float coeff = 1.0f;
+    float lagPerSlope = 0.0f;
+
+    // decayPowers[k] = (1 - coeff)^k, until it drops below the settle threshold
+    std::vector<float> decayPowers { 1.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SmoothedRamp)
+};
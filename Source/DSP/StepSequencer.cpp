@@ -2,106 +2,193 @@
   ==============================================================================
 
     StepSequencer.cpp
-    16-step gate sequencer with DAW tempo sync
+    Step gate sequencer with DAW tempo sync
 
   ==============================================================================
 */
 
 #include "StepSequencer.h"
+#include "../EnvGenConfig.h"
 
-StepSequencer::StepSequencer()
-{
-    // Initialize all steps to off
-    for (int i = 0; i < NUM_STEPS; ++i)
-        steps[i] = false;
-}
-
-void StepSequencer::prepare(double newSampleRate)
+template <int NumSteps>
+void StepSequencer<NumSteps>::prepare(double newSampleRate)
 {
     sampleRate = newSampleRate;
     reset();
 }
 
-void StepSequencer::reset()
+template <int NumSteps>
+void StepSequencer<NumSteps>::reset()
 {
     currentStep = 0;
     lastPpqPosition = -1.0;
+    expectedPpqPosition = -1.0;
 }
 
-bool StepSequencer::process(const juce::AudioPlayHead::PositionInfo& positionInfo)
+template <int NumSteps>
+int StepSequencer<NumSteps>::scheduleBlock(const juce::AudioPlayHead::PositionInfo& positionInfo, int numSamples, StepEvent* events)
 {
     // Check if we have valid position info and transport is playing
     if (!positionInfo.getIsPlaying())
     {
         lastPpqPosition = -1.0;
-        return false;
+        expectedPpqPosition = -1.0;
+        return 0;
     }
 
     auto ppqPositionOpt = positionInfo.getPpqPosition();
-    if (!ppqPositionOpt.hasValue())
-        return false;
-
-    double ppqPosition = *ppqPositionOpt;
-    double beatsPerStep = getBeatsPerStep();
-
-    // Calculate which step we're on based on PPQ position
-    // Wrap around for the 16 steps
-    double totalStepPosition = ppqPosition / beatsPerStep;
-    int newStep = static_cast<int>(std::fmod(totalStepPosition, static_cast<double>(NUM_STEPS)));
-    
-    // Handle negative PPQ (before song start)
-    if (newStep < 0)
-        newStep += NUM_STEPS;
-
-    // Check if we've moved to a new step
-    bool triggered = false;
-    if (newStep != currentStep)
+    if (!ppqPositionOpt.hasValue() || numSamples <= 0)
+        return 0;
+
+    const double ppqPosition = *ppqPositionOpt;
+    const double bpm = positionInfo.getBpm().orFallback(0.0);
+    const double samplesPerBeat = (bpm > 0.0) ? sampleRate * 60.0 / bpm : 0.0;
+    const double beatsPerStep = getBeatsPerStep();
+    int numEvents = 0;
+
+    // Block start: a new step begins here if we moved to another step, if this is the first
+    // block after reset/stop, or if the playhead jumped (seek, host-split loop) onto a step boundary
+    const int startStep = getStepAt(ppqPosition);
+    const double ppqTolerance = (samplesPerBeat > 0.0) ? 0.5 / samplesPerBeat : 0.0;
+    const bool continuous = lastPpqPosition >= 0.0 && std::abs(ppqPosition - expectedPpqPosition) <= ppqTolerance;
+    const double stepPosition = ppqPosition / beatsPerStep;
+    const bool onBoundary = stepPosition - std::floor(stepPosition) < 1.0e-9;
+
+    if (startStep != currentStep || lastPpqPosition < 0.0 || (!continuous && onBoundary))
+        numEvents = addEvent(events, numEvents, 0, startStep);
+
+    lastPpqPosition = ppqPosition;
+
+    // Without a tempo the boundaries inside the block can't be placed; evaluate the block start only
+    if (samplesPerBeat <= 0.0)
     {
-        currentStep = newStep;
-        
-        // Trigger if the new step is active
-        if (steps[currentStep])
+        expectedPpqPosition = -1.0;
+        return numEvents;
+    }
+
+    // Host loop wrapping inside the block (ignored if the loop is shorter than a sample)
+    double loopStart = 0.0, loopEnd = 0.0;
+    bool looping = false;
+    if (positionInfo.getIsLooping())
+    {
+        if (auto loopPoints = positionInfo.getLoopPoints())
         {
-            triggered = true;
+            loopStart = loopPoints->ppqStart;
+            loopEnd = loopPoints->ppqEnd;
+            looping = (loopEnd - loopStart) * samplesPerBeat >= 1.0;
         }
     }
-    else if (lastPpqPosition < 0.0)
+
+    double segmentPpq = ppqPosition;
+    int segmentStart = 0;
+
+    for (;;)
     {
-        // First call after reset/stop - check if current step should trigger
-        if (steps[currentStep])
+        int segmentEnd = numSamples;
+        double samplesToLoopEnd = 0.0;
+
+        if (looping && segmentPpq < loopEnd)
         {
-            triggered = true;
+            samplesToLoopEnd = (loopEnd - segmentPpq) * samplesPerBeat;
+            segmentEnd = juce::jmin(numSamples, segmentStart + static_cast<int>(std::ceil(samplesToLoopEnd)));
         }
+
+        numEvents = addBoundaries(events, numEvents, segmentPpq, samplesPerBeat, segmentStart, segmentEnd);
+
+        if (segmentEnd >= numSamples)
+        {
+            expectedPpqPosition = segmentPpq + (numSamples - segmentStart) / samplesPerBeat;
+            break;
+        }
+
+        // The playhead wraps back to the loop start at segmentEnd; the step there always starts anew
+        segmentPpq = loopStart + (segmentEnd - segmentStart - samplesToLoopEnd) / samplesPerBeat;
+        segmentStart = segmentEnd;
+        numEvents = addEvent(events, numEvents, segmentStart, getStepAt(segmentPpq));
     }
 
-    lastPpqPosition = ppqPosition;
-    return triggered;
+    return numEvents;
 }
 
-void StepSequencer::setStep(int stepIndex, bool active)
+template <int NumSteps>
+int StepSequencer<NumSteps>::addBoundaries(StepEvent* events, int numEvents, double segmentPpq, double samplesPerBeat,
+                                           int segmentStart, int segmentEnd)
 {
-    if (stepIndex >= 0 && stepIndex < NUM_STEPS)
-        steps[stepIndex] = active;
+    // Step k starts at PPQ k * beatsPerStep; its first sample is the first one at or after that point
+    const double beatsPerStep = getBeatsPerStep();
+    const double samplesPerStep = beatsPerStep * samplesPerBeat;
+    const double stepPosition = segmentPpq / beatsPerStep;
+
+    for (auto k = static_cast<int64_t>(std::floor(stepPosition)) + 1;; ++k)
+    {
+        const double samplesToBoundary = (static_cast<double>(k) - stepPosition) * samplesPerStep;
+        const int offset = segmentStart + static_cast<int>(std::ceil(samplesToBoundary - 1.0e-6));
+        if (offset >= segmentEnd)
+            break;
+        numEvents = addEvent(events, numEvents, offset, wrapStep(k));
+    }
+
+    return numEvents;
+}
+
+template <int NumSteps>
+int StepSequencer<NumSteps>::addEvent(StepEvent* events, int numEvents, int sampleOffset, int step)
+{
+    // Several boundaries landing on the same sample collapse into the last one
+    if (numEvents > 0 && events[numEvents - 1].sampleOffset == sampleOffset)
+        --numEvents;
+
+    currentStep = step;
+    events[numEvents] = { sampleOffset, step, getStep(step) };
+    return numEvents + 1;
 }
 
-bool StepSequencer::getStep(int stepIndex) const
+template <int NumSteps>
+int StepSequencer<NumSteps>::getStepAt(double ppqPosition) const
+{
+    return wrapStep(static_cast<int64_t>(std::floor(ppqPosition / getBeatsPerStep())));
+}
+
+template <int NumSteps>
+int StepSequencer<NumSteps>::wrapStep(int64_t stepCount) const
+{
+    // Wrap around for the NUM_STEPS steps; handles negative PPQ (before song start)
+    auto step = static_cast<int>(stepCount % NUM_STEPS);
+    return step < 0 ? step + NUM_STEPS : step;
+}
+
+template <int NumSteps>
+void StepSequencer<NumSteps>::setStep(int stepIndex, bool active)
+{
+    if (stepIndex < 0 || stepIndex >= NUM_STEPS)
+        return;
+
+    const auto bit = juce::uint32(1) << stepIndex;
+    stepMask = active ? (stepMask | bit) : (stepMask & ~bit);
+}
+
+template <int NumSteps>
+bool StepSequencer<NumSteps>::getStep(int stepIndex) const
 {
     if (stepIndex >= 0 && stepIndex < NUM_STEPS)
-        return steps[stepIndex];
+        return ((stepMask >> stepIndex) & 1u) != 0;
     return false;
 }
 
-void StepSequencer::setRate(Rate newRate)
+template <int NumSteps>
+void StepSequencer<NumSteps>::setRate(Rate newRate)
 {
     rate = newRate;
 }
 
-bool StepSequencer::isCurrentStepActive() const
+template <int NumSteps>
+bool StepSequencer<NumSteps>::isCurrentStepActive() const
 {
-    return steps[currentStep];
+    return getStep(currentStep);
 }
 
-double StepSequencer::getBeatsPerStep() const
+template <int NumSteps>
+double StepSequencer<NumSteps>::getBeatsPerStep() const
 {
     switch (rate)
     {
@@ -114,3 +201,5 @@ double StepSequencer::getBeatsPerStep() const
         default:                     return 0.25;
     }
 }
+
+template class StepSequencer<EnvGenConfig::numSteps>;
@@ -2,7 +2,7 @@
   ==============================================================================
 
     StepSequencer.h
-    16-step gate sequencer with DAW tempo sync
+    Step gate sequencer with DAW tempo sync
 
   ==============================================================================
 */
@@ -11,10 +11,14 @@
 
 #include <JuceHeader.h>
 
+// Templated on the step count so the step wrap is a compile-time modulo; instantiated in
+// StepSequencer.cpp for the build's ENVGEN_NUM_STEPS
+template <int NumSteps>
 class StepSequencer
 {
 public:
-    static constexpr int NUM_STEPS = 16;
+    static constexpr int NUM_STEPS = NumSteps;
+    static_assert(NUM_STEPS >= 1 && NUM_STEPS <= 32, "Steps are stored in a 32-bit mask");
 
     enum class Rate
     {
@@ -26,26 +30,40 @@ public:
         ThirtySecondNote // 1/32
     };
 
-    StepSequencer();
+    // A step boundary inside a block: the step that starts at sampleOffset
+    struct StepEvent
+    {
+        int sampleOffset = 0;
+        int step = 0;
+        bool trigger = false;   // true if that step is active
+    };
+
+    StepSequencer() = default;
     ~StepSequencer() = default;
 
     void prepare(double sampleRate);
     void reset();
 
-    // Process the sequencer for the current block
-    // Returns true if a step was triggered during this call
-    // Must be called once per sample
-    bool process(const juce::AudioPlayHead::PositionInfo& positionInfo);
+    // Schedule the step boundaries for a block of numSamples samples starting at the
+    // playhead position (block-start PPQ and BPM). Writes the sample-accurate events in
+    // ascending offset order, including boundaries after a host loop wraps inside the
+    // block, and returns how many were written. events must hold at least numSamples
+    // entries (there is never more than one event per sample).
+    int scheduleBlock(const juce::AudioPlayHead::PositionInfo& positionInfo, int numSamples, StepEvent* events);
 
     // Set/get step state
     void setStep(int stepIndex, bool active);
     bool getStep(int stepIndex) const;
 
+    // Set all steps at once (bit n = step n)
+    void setStepMask(juce::uint32 newStepMask) { stepMask = newStepMask; }
+    juce::uint32 getStepMask() const { return stepMask; }
+
     // Set/get rate
     void setRate(Rate newRate);
     Rate getRate() const { return rate; }
 
-    // Get current step index (0-15)
+    // Get current step index (0 to NUM_STEPS - 1)
     int getCurrentStep() const { return currentStep; }
 
     // Check if the current step is active
@@ -54,14 +72,21 @@ public:
 private:
     double sampleRate = 44100.0;
     
-    // Step states
-    bool steps[NUM_STEPS] = { false };
+    // Step states (bit n = step n)
+    juce::uint32 stepMask = 0;
 
     // Current state
     int currentStep = 0;
     Rate rate = Rate::SixteenthNote;
     double lastPpqPosition = -1.0;
+    double expectedPpqPosition = -1.0;  // where the next block should start if playback is continuous
 
     // Convert rate enum to beats per step
     double getBeatsPerStep() const;
+
+    int getStepAt(double ppqPosition) const;
+    int wrapStep(int64_t stepCount) const;
+    int addEvent(StepEvent* events, int numEvents, int sampleOffset, int step);
+    int addBoundaries(StepEvent* events, int numEvents, double segmentPpq, double samplesPerBeat,
+                      int segmentStart, int segmentEnd);
 };
@@ -0,0 +1,31 @@
+/*
+  ==============================================================================
+
+    EnvGenConfig.h
+    Build-time lane and step counts
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// One source tree builds every variant: CMake sets ENVGEN_NUM_LANES / ENVGEN_NUM_STEPS
+// (e.g. 4 lanes for the lite build, 16 or 32 for the large ones). The DSP classes are
+// templated on these counts so all per-lane loops have compile-time trip counts.
+#ifndef ENVGEN_NUM_LANES
+ #define ENVGEN_NUM_LANES 8
+#endif
+
+#ifndef ENVGEN_NUM_STEPS
+ #define ENVGEN_NUM_STEPS 16
+#endif
+
+namespace EnvGenConfig
+{
+    constexpr int numLanes = ENVGEN_NUM_LANES;
+    constexpr int numSteps = ENVGEN_NUM_STEPS;
+
+    // Lanes are addressed through 32-bit trigger masks and steps through a 32-bit step mask
+    static_assert(numLanes >= 1 && numLanes <= 32, "ENVGEN_NUM_LANES must be 1..32");
+    static_assert(numSteps >= 1 && numSteps <= 32, "ENVGEN_NUM_STEPS must be 1..32");
+}
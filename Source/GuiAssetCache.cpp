@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    GuiAssetCache.cpp
+    Process-wide in-memory copy of the built web GUI (gui/dist)
+
+  ==============================================================================
+*/
+
+#include "GuiAssetCache.h"
+
+const GuiAssetCache& GuiAssetCache::getInstance()
+{
+    // Function-local static: built once, thread-safe, and outlives every editor
+    static const GuiAssetCache instance;
+    return instance;
+}
+
+GuiAssetCache::GuiAssetCache()
+    : rootDirectory(findRootDirectory())
+{
+    if (rootDirectory == juce::File())
+        return;
+
+    for (const auto& entry : juce::RangedDirectoryIterator(rootDirectory, true, "*", juce::File::findFiles))
+    {
+        const auto& file = entry.getFile();
+
+        juce::MemoryBlock block;
+        if (!file.loadFileAsData(block))
+            continue;
+
+        Asset asset;
+        const auto* bytes = static_cast<const std::byte*>(block.getData());
+        asset.data.assign(bytes, bytes + block.getSize());
+        asset.mimeType = getMimeType(file);
+
+        assets.emplace(file.getRelativePathFrom(rootDirectory).replaceCharacter('\\', '/'), std::move(asset));
+    }
+
+    // Without an index page there is nothing to serve
+    if (assets.find("index.html") == assets.end())
+        assets.clear();
+}
+
+const GuiAssetCache::Asset* GuiAssetCache::find(const juce::String& path) const
+{
+    auto relativePath = path.upToFirstOccurrenceOf("?", false, false).trimCharactersAtStart("/");
+    if (relativePath.isEmpty())
+        relativePath = "index.html";
+
+    const auto found = assets.find(relativePath);
+    return found != assets.end() ? &found->second : nullptr;
+}
+
+juce::File GuiAssetCache::findRootDirectory()
+{
+    auto isGuiRoot = [](const juce::File& dir) { return dir.getChildFile("index.html").existsAsFile(); };
+
+    auto exe = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+    auto dir = exe.getParentDirectory();
+    // Standalone: exe is in .../MacOS/ or .../Debug/; try EnvGenGui next to it
+    auto envGenGui = dir.getChildFile("EnvGenGui");
+    if (isGuiRoot(envGenGui))
+        return envGenGui;
+    // macOS app bundle: Contents/Resources/EnvGenGui
+    envGenGui = dir.getParentDirectory().getChildFile("Resources").getChildFile("EnvGenGui");
+    if (isGuiRoot(envGenGui))
+        return envGenGui;
+    // Source tree for development: executable might be in build/.../Debug, gui/dist at repo root
+    auto maybeDist = dir.getParentDirectory().getParentDirectory().getChildFile("gui").getChildFile("dist");
+    if (isGuiRoot(maybeDist))
+        return maybeDist;
+    return {};
+}
+
+juce::String GuiAssetCache::getMimeType(const juce::File& file)
+{
+    const auto ext = file.getFileExtension().toLowerCase();
+    if (ext == ".html" || ext == ".htm")    return "text/html";
+    if (ext == ".js" || ext == ".mjs")      return "application/javascript";
+    if (ext == ".css")                      return "text/css";
+    if (ext == ".json" || ext == ".map")    return "application/json";
+    if (ext == ".svg")                      return "image/svg+xml";
+    if (ext == ".png")                      return "image/png";
+    if (ext == ".ico")                      return "image/x-icon";
+    if (ext == ".woff2")                    return "font/woff2";
+    if (ext == ".woff")                     return "font/woff";
+    return "application/octet-stream";
+}
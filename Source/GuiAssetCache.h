@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    GuiAssetCache.h
+    Process-wide in-memory copy of the built web GUI (gui/dist)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Every editor instance serves the same page, so the built GUI is found and read from disk
+// once per process, the first time any web editor opens, and kept for the process lifetime.
+// After that it is read-only: the resource provider can look assets up from any thread and
+// no editor open touches the disk.
+class GuiAssetCache
+{
+public:
+    struct Asset
+    {
+        std::vector<std::byte> data;
+        juce::String mimeType;
+    };
+
+    // Loads on first use
+    static const GuiAssetCache& getInstance();
+
+    bool isAvailable() const { return !assets.empty(); }
+    const juce::File& getRootDirectory() const { return rootDirectory; }
+
+    // path as requested by the page ("/", "/assets/index-abc.js"); nullptr if not in the build
+    const Asset* find(const juce::String& path) const;
+
+private:
+    GuiAssetCache();
+
+    juce::File rootDirectory;
+    std::unordered_map<juce::String, Asset> assets;   // keyed by path relative to the root, '/'-separated
+
+    static juce::File findRootDirectory();
+    static juce::String getMimeType(const juce::File& file);
+
+    JUCE_DECLARE_NON_COPYABLE(GuiAssetCache)
+};
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    LaneParameters.h
+    Per-lane parameter snapshot and its lock-free handoff to the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Plain copy of one lane's parameters, as the audio thread uses them. */
+struct LaneParameterSnapshot
+{
+    juce::uint32 stepMask = 0;     // bit n set = step n active
+    float attack = 0.01f;          // seconds
+    float hold = 0.1f;             // seconds
+    float decay = 0.5f;            // seconds
+    float amount = 1.0f;
+    int rate = 4;                  // StepSequencer::Rate index
+    int destination = 0;           // 0 = None, 1 = Amplitude
+
+    /** Modulation amount to sum into the gain curve (0 unless assigned to Amplitude). */
+    float getAmplitudeAmount() const { return destination == 1 ? amount : 0.0f; }
+};
+
+//==============================================================================
+/** One lane's parameters shared between the parameter listener and the audio thread.
+
+    Writers (message thread, or the audio thread during host automation) store the changed
+    value and then bump the version. The audio thread compares the version once per block
+    and only copies the values out when it moved, so unchanged lanes cost one atomic load.
+    A read that overlaps a write just sees the version move again and re-reads next block.
+*/
+class SharedLaneParameters
+{
+public:
+    enum class Field
+    {
+        Step,
+        Attack,
+        Hold,
+        Decay,
+        Amount,
+        Rate,
+        Destination
+    };
+
+    void setStep(int stepIndex, bool active)
+    {
+        const auto bit = juce::uint32(1) << stepIndex;
+        if (active)
+            stepMask.fetch_or(bit, std::memory_order_relaxed);
+        else
+            stepMask.fetch_and(~bit, std::memory_order_relaxed);
+        publish();
+    }
+
+    void setFloat(Field field, float value)
+    {
+        switch (field)
+        {
+            case Field::Attack: attack.store(value, std::memory_order_relaxed); break;
+            case Field::Hold:   hold.store(value, std::memory_order_relaxed); break;
+            case Field::Decay:  decay.store(value, std::memory_order_relaxed); break;
+            case Field::Amount: amount.store(value, std::memory_order_relaxed); break;
+            default:            jassertfalse; return;
+        }
+        publish();
+    }
+
+    void setChoice(Field field, int index)
+    {
+        switch (field)
+        {
+            case Field::Rate:        rate.store(index, std::memory_order_relaxed); break;
+            case Field::Destination: destination.store(index, std::memory_order_relaxed); break;
+            default:                 jassertfalse; return;
+        }
+        publish();
+    }
+
+    juce::uint32 getVersion() const { return version.load(std::memory_order_acquire); }
+
+    LaneParameterSnapshot load() const
+    {
+        LaneParameterSnapshot s;
+        s.stepMask = stepMask.load(std::memory_order_relaxed);
+        s.attack = attack.load(std::memory_order_relaxed);
+        s.hold = hold.load(std::memory_order_relaxed);
+        s.decay = decay.load(std::memory_order_relaxed);
+        s.amount = amount.load(std::memory_order_relaxed);
+        s.rate = rate.load(std::memory_order_relaxed);
+        s.destination = destination.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::atomic<juce::uint32> stepMask { 0 };
+    std::atomic<float> attack { 0.01f };
+    std::atomic<float> hold { 0.1f };
+    std::atomic<float> decay { 0.5f };
+    std::atomic<float> amount { 1.0f };
+    std::atomic<int> rate { 4 };
+    std::atomic<int> destination { 0 };
+    std::atomic<juce::uint32> version { 1 };
+
+    void publish() { version.fetch_add(1, std::memory_order_release); }
+};
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    ParameterTable.h
+    Compile-time parameter layout: stable integer indices for every parameter
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <iterator>
+
+// Parameters are created, stored by the host and exposed through getParameters() in this
+// order, so an index into it is the parameter's index everywhere: in the processor, on the
+// web bridge and in the page's PARAMS table (which the page builds from the same counts).
+// String IDs are only made for the host and saved state.
+//
+//   [ global parameters ][ lane 1: steps..., envelope slots... ][ lane 2 ... ] ...
+template <int NumLanes, int NumSteps>
+struct ParameterTable
+{
+    enum Global
+    {
+        inputGain,
+        outputGain,
+        dryPass,
+        numLanes,
+        numGlobals
+    };
+
+    // Per-lane parameters after the lane's steps, in creation order
+    enum class LaneSlot
+    {
+        attack,
+        hold,
+        decay,
+        rate,
+        destination,
+        amount,
+        count
+    };
+
+    static constexpr int numLaneSlots = static_cast<int>(LaneSlot::count);
+    static constexpr int laneStride = NumSteps + numLaneSlots;
+    static constexpr int numParameters = numGlobals + NumLanes * laneStride;
+
+    static constexpr int getStepIndex(int lane, int step) { return numGlobals + lane * laneStride + step; }
+
+    static constexpr int getLaneSlotIndex(int lane, LaneSlot slot)
+    {
+        return numGlobals + lane * laneStride + NumSteps + static_cast<int>(slot);
+    }
+
+    // Where an index points: lane < 0 for a global parameter, step < 0 for a lane slot
+    struct Location
+    {
+        int lane = -1;
+        int step = -1;
+        LaneSlot slot = LaneSlot::count;
+    };
+
+    static constexpr Location locate(int index)
+    {
+        Location location;
+        if (index < numGlobals || index >= numParameters)
+            return location;
+
+        const int offset = index - numGlobals;
+        location.lane = offset / laneStride;
+        const int withinLane = offset % laneStride;
+        if (withinLane < NumSteps)
+            location.step = withinLane;
+        else
+            location.slot = static_cast<LaneSlot>(withinLane - NumSteps);
+        return location;
+    }
+
+    // Host / saved-state ID, e.g. "inputGain", "lane3_step7", "lane3_attack"
+    static juce::String getParameterId(int index)
+    {
+        static constexpr const char* globalIds[] = { "inputGain", "outputGain", "dryPass", "numLanes" };
+        static constexpr const char* slotIds[] = { "attack", "hold", "decay", "rate", "destination", "amount" };
+        static_assert(std::size(globalIds) == numGlobals && std::size(slotIds) == numLaneSlots, "ID tables out of step");
+
+        const auto location = locate(index);
+        if (location.lane < 0)
+            return index >= 0 && index < numGlobals ? juce::String(globalIds[index]) : juce::String();
+
+        const auto prefix = "lane" + juce::String(location.lane + 1) + "_";
+        if (location.step >= 0)
+            return prefix + "step" + juce::String(location.step);
+        return prefix + slotIds[static_cast<int>(location.slot)];
+    }
+
+    static_assert(locate(getStepIndex(NumLanes - 1, NumSteps - 1)).step == NumSteps - 1, "Layout doesn't round-trip");
+    static_assert(locate(getLaneSlotIndex(NumLanes - 1, LaneSlot::amount)).slot == LaneSlot::amount, "Layout doesn't round-trip");
+    static_assert(getLaneSlotIndex(NumLanes - 1, LaneSlot::amount) == numParameters - 1, "Layout doesn't cover every parameter");
+};
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.cpp
+    Opt-in audio-thread timing: per-block cost histogram, overruns and stage costs
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+//==============================================================================
+double PerformanceMonitor::Snapshot::getLoad() const
+{
+    if (samples == 0 || sampleRate <= 0.0)
+        return 0.0;
+    return static_cast<double>(totalNanos) * 1.0e-9 / (static_cast<double>(samples) / sampleRate);
+}
+
+double PerformanceMonitor::Snapshot::getAverageNanosPerSample() const
+{
+    return samples > 0 ? static_cast<double>(totalNanos) / static_cast<double>(samples) : 0.0;
+}
+
+double PerformanceMonitor::Snapshot::getAverageStageNanosPerBlock(Stage stage) const
+{
+    const auto index = static_cast<size_t>(stage);
+    return blocks > 0 ? static_cast<double>(stageNanos[index]) / static_cast<double>(blocks) : 0.0;
+}
+
+double PerformanceMonitor::Snapshot::getNanosPerSamplePercentile(double fraction) const
+{
+    juce::uint64 total = 0;
+    for (auto count : histogram)
+        total += count;
+
+    if (total == 0)
+        return 0.0;
+
+    const auto target = static_cast<juce::uint64>(std::ceil(juce::jlimit(0.0, 1.0, fraction) * static_cast<double>(total)));
+    juce::uint64 seen = 0;
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += histogram[i];
+        if (seen >= target)
+            return getBucketUpperBound(i);
+    }
+    return getBucketUpperBound(numBuckets - 1);
+}
+
+juce::String PerformanceMonitor::Snapshot::getSummary() const
+{
+    if (!enabled)
+        return "Performance monitor off";
+    if (blocks == 0)
+        return "Waiting for audio...";
+
+    return "CPU " + juce::String(getLoad() * 100.0, 2) + "%"
+         + "  avg " + juce::String(getAverageNanosPerSample(), 1) + " ns/smp"
+         + "  p99 < " + juce::String(getNanosPerSamplePercentile(0.99), 0) + " ns/smp"
+         + "  max " + juce::String(maxNanosPerSample, 0) + " ns/smp"
+         + "  overruns " + juce::String(static_cast<juce::int64>(overruns));
+}
+
+//==============================================================================
+PerformanceMonitor::PerformanceMonitor()
+    : nanosPerTick(1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()))
+{
+}
+
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.enabled = isEnabled();
+    snapshot.sampleRate = sampleRate.load(std::memory_order_relaxed);
+    snapshot.blocks = blocks.load(std::memory_order_relaxed);
+    snapshot.samples = samples.load(std::memory_order_relaxed);
+    snapshot.overruns = overruns.load(std::memory_order_relaxed);
+    snapshot.totalNanos = totalNanos.load(std::memory_order_relaxed);
+    snapshot.maxBlockNanos = maxBlockNanos.load(std::memory_order_relaxed);
+    snapshot.maxNanosPerSample = maxNanosPerSample.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < numStages; ++i)
+        snapshot.stageNanos[i] = stageNanos[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < numBuckets; ++i)
+        snapshot.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+void PerformanceMonitor::clear()
+{
+    blocks.store(0, std::memory_order_relaxed);
+    samples.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    totalNanos.store(0, std::memory_order_relaxed);
+    maxBlockNanos.store(0, std::memory_order_relaxed);
+    maxNanosPerSample.store(0.0, std::memory_order_relaxed);
+
+    for (auto& stage : stageNanos)
+        stage.store(0, std::memory_order_relaxed);
+    for (auto& bucket : histogram)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::recordBlock(int numSamples, double blockSampleRate, juce::int64 blockTicks, const juce::int64* stageTicks)
+{
+    if (resetRequested.exchange(false, std::memory_order_relaxed))
+        clear();
+
+    // Single writer: plain load/store pairs are enough, no read-modify-write needed
+    auto add = [](auto& counter, auto amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    };
+
+    const auto nanos = ticksToNanos(blockTicks);
+    const double nanosPerSample = static_cast<double>(nanos) / static_cast<double>(numSamples);
+
+    sampleRate.store(blockSampleRate, std::memory_order_relaxed);
+    add(blocks, juce::uint64(1));
+    add(samples, static_cast<juce::uint64>(numSamples));
+    add(totalNanos, nanos);
+
+    // The block had numSamples / sampleRate seconds of real time to finish in
+    if (blockSampleRate > 0.0 && static_cast<double>(nanos) > numSamples * 1.0e9 / blockSampleRate)
+        add(overruns, juce::uint64(1));
+
+    if (nanos > maxBlockNanos.load(std::memory_order_relaxed))
+        maxBlockNanos.store(nanos, std::memory_order_relaxed);
+    if (nanosPerSample > maxNanosPerSample.load(std::memory_order_relaxed))
+        maxNanosPerSample.store(nanosPerSample, std::memory_order_relaxed);
+
+    for (int i = 0; i < numStages; ++i)
+        add(stageNanos[i], ticksToNanos(stageTicks[i]));
+
+    // Half-octave buckets: bucket i ends at 2^((i + 1) / 2) ns per sample
+    const int bucket = nanosPerSample > 1.0 ? static_cast<int>(std::floor(2.0 * std::log2(nanosPerSample))) : 0;
+    add(histogram[juce::jlimit(0, numBuckets - 1, bucket)], juce::uint32(1));
+}
+
+juce::uint64 PerformanceMonitor::ticksToNanos(juce::int64 ticks) const
+{
+    return static_cast<juce::uint64>(static_cast<double>(juce::jmax(juce::int64(0), ticks)) * nanosPerTick);
+}
+
+//==============================================================================
+PerformanceMonitor::BlockScope::BlockScope(PerformanceMonitor& monitorToUse, int numSamplesInBlock, double blockSampleRate)
+    : monitor(monitorToUse),
+      active(monitorToUse.isEnabled() && numSamplesInBlock > 0),
+      numSamples(numSamplesInBlock),
+      sampleRate(blockSampleRate)
+{
+    if (active)
+        startTicks = stageStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+PerformanceMonitor::BlockScope::~BlockScope()
+{
+    if (active)
+        monitor.recordBlock(numSamples, sampleRate, juce::Time::getHighResolutionTicks() - startTicks, stageTicks);
+}
+
+void PerformanceMonitor::BlockScope::endStage(Stage stage)
+{
+    if (!active)
+        return;
+
+    const auto now = juce::Time::getHighResolutionTicks();
+    stageTicks[static_cast<size_t>(stage)] += now - stageStartTicks;
+    stageStartTicks = now;
+}
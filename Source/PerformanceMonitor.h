@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    PerformanceMonitor.h
+    Opt-in audio-thread timing: per-block cost histogram, overruns and stage costs
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// Written only by the audio thread, read by the editor. Every counter is a relaxed atomic,
+// so a reader takes a wait-free snapshot by loading each of them; a snapshot may straddle
+// one block, which doesn't matter for statistics. Disabled (the default), the audio
+// thread pays one atomic load per block.
+class PerformanceMonitor
+{
+public:
+    enum class Stage
+    {
+        Parameters,   // picking up lane parameter snapshots
+        Render,       // sequencers, envelopes and modulation sum
+        Gain,         // gain curve and applying it to the channels
+        Scope         // pushing data to the scope sink
+    };
+
+    static constexpr int numStages = 4;
+
+    // Histogram of ns per sample in half-octave buckets: bucket i holds blocks whose cost
+    // was below getBucketUpperBound(i) (1 ns/sample up to ~46 us/sample)
+    static constexpr int numBuckets = 32;
+
+    static double getBucketUpperBound(int bucket) { return std::exp2(0.5 * (bucket + 1)); }
+
+    struct Snapshot
+    {
+        bool enabled = false;
+        double sampleRate = 0.0;
+        juce::uint64 blocks = 0;
+        juce::uint64 samples = 0;
+        juce::uint64 overruns = 0;            // blocks that took longer than their own duration
+        juce::uint64 totalNanos = 0;
+        juce::uint64 maxBlockNanos = 0;
+        double maxNanosPerSample = 0.0;
+        juce::uint64 stageNanos[numStages] = {};
+        juce::uint32 histogram[numBuckets] = {};
+
+        // Share of real time spent in processBlock (1.0 = the whole budget)
+        double getLoad() const;
+        double getAverageNanosPerSample() const;
+        double getAverageStageNanosPerBlock(Stage stage) const;
+
+        // Upper bound of the histogram bucket holding the given fraction of blocks
+        double getNanosPerSamplePercentile(double fraction) const;
+
+        // One-line summary for the editors
+        juce::String getSummary() const;
+    };
+
+    PerformanceMonitor();
+    ~PerformanceMonitor() = default;
+
+    // Any thread
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Clears the statistics at the start of the next block
+    void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+    // Editor: wait-free copy of the current statistics
+    Snapshot getSnapshot() const;
+
+    // Audio thread: times one processBlock call. Stage costs are the time since the previous
+    // endStage() (or the start of the block); calling it again for a stage adds to it.
+    class BlockScope
+    {
+    public:
+        BlockScope(PerformanceMonitor& monitorToUse, int numSamples, double sampleRate);
+        ~BlockScope();
+
+        void endStage(Stage stage);
+
+    private:
+        PerformanceMonitor& monitor;
+        const bool active;
+        const int numSamples;
+        const double sampleRate;
+        juce::int64 startTicks = 0;
+        juce::int64 stageStartTicks = 0;
+        juce::int64 stageTicks[numStages] = {};
+
+        JUCE_DECLARE_NON_COPYABLE(BlockScope)
+    };
+
+private:
+    const double nanosPerTick;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<bool> resetRequested { false };
+
+    std::atomic<double> sampleRate { 0.0 };
+    std::atomic<juce::uint64> blocks { 0 };
+    std::atomic<juce::uint64> samples { 0 };
+    std::atomic<juce::uint64> overruns { 0 };
+    std::atomic<juce::uint64> totalNanos { 0 };
+    std::atomic<juce::uint64> maxBlockNanos { 0 };
+    std::atomic<double> maxNanosPerSample { 0.0 };
+    std::atomic<juce::uint64> stageNanos[numStages] = {};
+    std::atomic<juce::uint32> histogram[numBuckets] = {};
+
+    void clear();
+    void recordBlock(int numSamples, double blockSampleRate, juce::int64 blockTicks, const juce::int64* stageTicks);
+
+    juce::uint64 ticksToNanos(juce::int64 ticks) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceMonitor)
+};
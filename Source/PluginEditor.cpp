@@ -64,6 +64,24 @@ EnvGenAudioProcessorEditor::EnvGenAudioProcessorEditor(EnvGenAudioProcessor& p)
     resetAllButton.onClick = [this]() { audioProcessor.resetAllParametersToDefault(); };
     addAndMakeVisible(resetAllButton);
 
+    // Performance monitor (opt-in: timing only runs while the toggle is on)
+    perfButton.setButtonText("Perf");
+    perfButton.setColour(juce::ToggleButton::tickColourId, CustomLookAndFeel::accentColour);
+    perfButton.setColour(juce::ToggleButton::tickDisabledColourId, CustomLookAndFeel::textColour.withAlpha(0.5f));
+    perfButton.setToggleState(audioProcessor.getPerformanceMonitor().isEnabled(), juce::dontSendNotification);
+    perfButton.onClick = [this]()
+    {
+        auto& monitor = audioProcessor.getPerformanceMonitor();
+        monitor.requestReset();
+        monitor.setEnabled(perfButton.getToggleState());
+    };
+    addAndMakeVisible(perfButton);
+
+    perfLabel.setFont(juce::Font(juce::FontOptions(11.0f)));
+    perfLabel.setJustificationType(juce::Justification::centredLeft);
+    perfLabel.setColour(juce::Label::textColourId, CustomLookAndFeel::textColour);
+    addAndMakeVisible(perfLabel);
+
     // Create oscilloscope display
     oscilloscope = std::make_unique<OsciloscopeComponent>();
     
@@ -84,8 +102,9 @@ EnvGenAudioProcessorEditor::EnvGenAudioProcessorEditor(EnvGenAudioProcessor& p)
     envelopeLane = std::make_unique<EnvelopeLane>(audioProcessor.apvts, 1);
     addAndMakeVisible(*envelopeLane);
 
-    // Start timer for step visualization
-    startTimerHz(30);
+    // Scope and step display both refresh from the display's vblank
+    refreshDriver.addClient(oscilloscope.get());
+    refreshDriver.addClient(this);
 
     setSize(900, 520);
 }
@@ -95,7 +114,8 @@ EnvGenAudioProcessorEditor::~EnvGenAudioProcessorEditor()
     // Unregister oscilloscope from processor before destroying
     audioProcessor.setScopeSink(nullptr);
     
-    stopTimer();
+    refreshDriver.removeClient(this);
+    refreshDriver.removeClient(oscilloscope.get());
     setLookAndFeel(nullptr);
 }
 
@@ -149,6 +169,11 @@ void EnvGenAudioProcessorEditor::resized()
     // Reset All button (right side of header)
     auto resetArea = headerSection.removeFromRight(80);
     resetAllButton.setBounds(resetArea.reduced(0, 18));
+    headerSection.removeFromRight(margin);
+
+    // Performance monitor toggle and readout (between Dry and Reset All)
+    perfButton.setBounds(headerSection.removeFromLeft(55).reduced(0, 18));
+    perfLabel.setBounds(headerSection.reduced(0, 15));
 
     bounds.removeFromTop(margin);
 
@@ -162,8 +187,16 @@ void EnvGenAudioProcessorEditor::resized()
     envelopeLane->setBounds(laneArea);
 }
 
-void EnvGenAudioProcessorEditor::timerCallback()
+void EnvGenAudioProcessorEditor::refresh()
 {
     int currentStep = audioProcessor.getCurrentStep(0);
     envelopeLane->setCurrentStep(currentStep);
+
+    // Performance readout at ~4 Hz
+    const auto nowMs = juce::Time::getMillisecondCounter();
+    if (nowMs - lastPerfRefreshMs >= 250)
+    {
+        lastPerfRefreshMs = nowMs;
+        perfLabel.setText(audioProcessor.getPerformanceMonitor().getSnapshot().getSummary(), juce::dontSendNotification);
+    }
 }
@@ -14,10 +14,11 @@
 #include "Components/CustomLookAndFeel.h"
 #include "Components/EnvelopeLane.h"
 #include "Components/OscilloscopeComponent.h"
+#include "Components/RefreshDriver.h"
 
 //==============================================================================
 class EnvGenAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                    public juce::Timer
+                                    private RefreshDriver::Client
 {
 public:
     EnvGenAudioProcessorEditor(EnvGenAudioProcessor&);
@@ -26,7 +27,6 @@ public:
     //==============================================================================
     void paint(juce::Graphics&) override;
     void resized() override;
-    void timerCallback() override;
 
 private:
     EnvGenAudioProcessor& audioProcessor;
@@ -46,11 +46,22 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> outputGainAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> dryPassAttachment;
 
+    // Performance monitor toggle and readout
+    juce::ToggleButton perfButton;
+    juce::Label perfLabel;
+    juce::uint32 lastPerfRefreshMs = 0;
+
     // Oscilloscope display
     std::unique_ptr<OsciloscopeComponent> oscilloscope;
 
     // Single envelope lane
     std::unique_ptr<EnvelopeLane> envelopeLane;
 
+    // Paces the scope and the step display; declared last so it goes first
+    RefreshDriver refreshDriver { *this };
+
+    // RefreshDriver::Client: step display and performance readout
+    void refresh() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EnvGenAudioProcessorEditor)
 };
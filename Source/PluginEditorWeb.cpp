@@ -1,6 +1,7 @@
 #if ENVGEN_USE_WEB_GUI && JUCE_WEB_BROWSER
 
 #include "PluginEditorWeb.h"
+#include <algorithm>
 #include <cstring>
 #if JUCE_MAC
 #include "EnvelopeOverlayMac.h"
@@ -44,109 +45,66 @@ namespace
 var c=document.getElementById('c'),ctx=c.getContext('2d');
 function resize(){c.width=c.offsetWidth;c.height=c.offsetHeight;}
 window.onresize=resize;resize();
-window.__ENVGEN__=window.__ENVGEN__||{};
-window.__ENVGEN__.drawEnvelopes=function(lanes,width,height){
-if(!lanes||lanes.length===0)return;
-var w=c.width,h=c.height;
-if(width>0&&height>0){w=width;h=height;c.width=w;c.height=h;}
-ctx.clearRect(0,0,w,h);
-var maxVal=0;
-for(var L=0;L<lanes.length;L++){
-  var points=lanes[L].points;
-  if(!points||points.length===0)continue;
-  var smoothed=points.slice();
-  for(var i=0;i<smoothed.length;i++){
-    if(i>=2&&i<smoothed.length-2)
-      smoothed[i]=(points[i-2]+4*points[i-1]+6*points[i]+4*points[i+1]+points[i+2])/16;
-    else if(i>=1&&i<smoothed.length-1)
-      smoothed[i]=(points[i-1]+points[i]*2+points[i+1])/4;
-    if(smoothed[i]>maxVal)maxVal=smoothed[i];
+var lanes=[],colors=[],peaks=[],numLanes=0;
+function decode(b64){
+  var bin=atob(b64),bytes=new Uint8Array(bin.length);
+  for(var i=0;i<bin.length;i++)bytes[i]=bin.charCodeAt(i);
+  return new Float32Array(bytes.buffer);
+}
+function draw(width,height){
+  var w=c.width,h=c.height;
+  if(width>0&&height>0&&(width!==w||height!==h)){w=width;h=height;c.width=w;c.height=h;}
+  ctx.clearRect(0,0,w,h);
+  var maxVal=0;
+  for(var L=0;L<numLanes;L++)if(lanes[L]&&peaks[L]>maxVal)maxVal=peaks[L];
+  if(maxVal<0.01)return;
+  var scale=(h*0.9)/maxVal;
+  ctx.lineWidth=2;ctx.lineJoin='round';ctx.lineCap='round';
+  for(var L=0;L<numLanes;L++){
+    var points=lanes[L];
+    if(!points||points.length===0)continue;
+    ctx.strokeStyle=colors[L]||'rgba(0,255,170,0.8)';
+    ctx.beginPath();
+    for(var i=0;i<points.length;i++){
+      var x=(points.length>1)?(i/(points.length-1))*w:0;
+      var y=h-points[i]*scale;
+      if(i===0)ctx.moveTo(x,y);else ctx.lineTo(x,y);
+    }
+    ctx.stroke();
   }
-  lanes[L]._smoothed=smoothed;
 }
-if(maxVal<0.01)return;
-var scale=(h*0.9)/maxVal;
-ctx.lineWidth=2;ctx.lineJoin='round';ctx.lineCap='round';
-for(var L=0;L<lanes.length;L++){
-  var smoothed=lanes[L]._smoothed;
-  if(!smoothed)continue;
-  ctx.strokeStyle=lanes[L].color||'rgba(0,255,170,0.8)';
-  ctx.beginPath();
-  for(var i=0;i<smoothed.length;i++){
-    var x=(smoothed.length>1)?(i/(smoothed.length-1))*w:0;
-    var y=h-smoothed[i]*scale;
-    if(i===0)ctx.moveTo(x,y);else ctx.lineTo(x,y);
+// Frames carry already-smoothed lanes as base64 little-endian Float32 arrays, and only
+// the lanes that changed; the others keep their last data
+function onFrame(frame){
+  if(!frame)return;
+  numLanes=frame.numLanes|0;
+  var changed=frame.lanes||[];
+  for(var k=0;k<changed.length;k++){
+    var lane=changed[k],points=lane.points?decode(lane.points):null,peak=0;
+    if(points)for(var i=0;i<points.length;i++)if(points[i]>peak)peak=points[i];
+    lanes[lane.index]=points;colors[lane.index]=lane.color;peaks[lane.index]=peak;
   }
-  ctx.stroke();
+  draw(frame.width|0,frame.height|0);
+}
+var backend=window.__JUCE__&&window.__JUCE__.backend;
+if(backend){
+  backend.addEventListener('envelopeFrame',onFrame);
+  backend.emitEvent('envelopeOverlayReady',{});
 }
-};
 })();
 </script></body></html>
 )ENVHTML";
         juce::MemoryBlock mb(html, std::strlen(html));
         juce::String enc = juce::Base64::toBase64(mb.getData(), mb.getSize());
-        // #region agent log
-        juce::String prefix = enc.substring(0, 40);
-        juce::File logFile("/Users/aldenbraverman/Desktop/opal_juce/env_gen/.cursor/debug.log");
-        if (auto stream = logFile.createOutputStream(std::ios::app))
-        {
-            stream->writeText("{\"hypothesisId\":\"H1\",\"location\":\"PluginEditorWeb.cpp:getEnvelopeOverlayDataUrl\",\"message\":\"encoding prefix\",\"data\":{\"encodingPrefix\":\"" + prefix.replace("\"", "\\\"").replace("\\", "\\\\") + "\",\"encodingLen\":" + juce::String(enc.length()) + "},\"timestamp\":\"post-fix\"}\n", false, false, nullptr);
-        }
-        // #endregion
         return "data:text/html;base64," + enc;
     }
-
-    static const juce::StringArray& getParamIds()
-    {
-        static juce::StringArray ids;
-        if (ids.isEmpty())
-        {
-            ids.add("inputGain");
-            ids.add("outputGain");
-            ids.add("dryPass");
-            ids.add("numLanes");
-            for (int lane = 1; lane <= 8; ++lane)
-            {
-                juce::String prefix = "lane" + juce::String(lane) + "_";
-                for (int step = 0; step < 16; ++step)
-                    ids.add(prefix + "step" + juce::String(step));
-                ids.add(prefix + "attack");
-                ids.add(prefix + "hold");
-                ids.add(prefix + "decay");
-                ids.add(prefix + "rate");
-                ids.add(prefix + "destination");
-                ids.add(prefix + "amount");
-            }
-        }
-        return ids;
-    }
-
-    juce::File getGuiRootDirectory()
-    {
-        auto exe = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
-        auto dir = exe.getParentDirectory();
-        // Standalone: exe is in .../MacOS/ or .../Debug/; try EnvGenGui next to it
-        auto envGenGui = dir.getChildFile("EnvGenGui");
-        if (envGenGui.exists() && envGenGui.getChildFile("index.html").exists())
-            return envGenGui;
-        // macOS app bundle: Contents/Resources/EnvGenGui
-        auto resources = dir.getParentDirectory().getChildFile("Resources");
-        envGenGui = resources.getChildFile("EnvGenGui");
-        if (envGenGui.exists() && envGenGui.getChildFile("index.html").exists())
-            return envGenGui;
-        // Source tree for development: executable might be in build/.../Debug, gui/dist at repo root
-        auto maybeDist = exe.getParentDirectory().getParentDirectory().getParentDirectory().getChildFile("gui").getChildFile("dist");
-        if (maybeDist.exists() && maybeDist.getChildFile("index.html").exists())
-            return maybeDist;
-        return {};
-    }
 }
 
 //==============================================================================
 EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
     : AudioProcessorEditor(&p),
       processorRef(p),
-      guiRootDir(getGuiRootDirectory())
+      guiAssets(GuiAssetCache::getInstance())
 {
     setSize(kDesignWidth, kDesignHeight);
     setResizable(true, true);
@@ -156,14 +114,33 @@ EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
     oscilloscope->setShowEnvelope(true);
     addAndMakeVisible(oscilloscope.get());
     processorRef.setScopeSink(oscilloscope.get());
+    refreshDriver.addClient(oscilloscope.get());
 
-    auto& apvts = processorRef.apvts;
-    for (const auto& id : getParamIds())
-        apvts.addParameterListener(id, this);
+    // The page addresses parameters by index (ParameterTable order, which its PARAMS table
+    // follows), so neither direction carries string IDs
+    const auto& params = processorRef.getParameters();
+    jassert(params.size() == numWebParams);
+    for (int i = 0; i < juce::jmin(params.size(), numWebParams); ++i)
+    {
+        webParams[static_cast<size_t>(i)] = dynamic_cast<juce::RangedAudioParameter*>(params[i]);
+        params[i]->addListener(this);
+    }
+    refreshDriver.addClient(this);
 
     juce::WebBrowserComponent::Options options;
     options = options.withNativeIntegrationEnabled(true);
 
+    // The web UI builds its parameter list from the lane/step counts of this build, and maps
+    // IDs to indices from the IDs in index order (it refuses to write if the sets differ)
+    juce::Array<juce::var> parameterIds;
+    for (int i = 0; i < numWebParams; ++i)
+        parameterIds.add(EnvGenAudioProcessor::Params::getParameterId(i));
+
+    options = options.withInitialisationData("numLanes", EnvGenAudioProcessor::NUM_LANES)
+                     .withInitialisationData("numSteps", EnvGenAudioProcessor::NUM_STEPS)
+                     .withInitialisationData("parameterIds", parameterIds)
+                     .withInitialisationData("instanceId", processorRef.getInstanceId());
+
 #if JUCE_WINDOWS
     options = options.withWinWebView2Options(
         options.getWinWebView2BackendOptions().withUserDataFolder(
@@ -171,69 +148,92 @@ EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
 #endif
 
 #if JUCE_WEB_BROWSER_RESOURCE_PROVIDER_AVAILABLE
-    if (guiRootDir.exists())
+    if (guiAssets.isAvailable())
     {
-        auto provider = [root = guiRootDir](const juce::String& path) -> std::optional<juce::WebBrowserComponent::Resource>
+        // Served from the shared in-memory cache: no disk access per request or per editor
+        auto provider = [&assets = guiAssets](const juce::String& path) -> std::optional<juce::WebBrowserComponent::Resource>
         {
-            juce::String pathTrimmed = path.trimCharactersAtStart("/");
-            if (pathTrimmed.isEmpty())
-                pathTrimmed = "index.html";
-            juce::File f = root.getChildFile(pathTrimmed);
-            if (!f.existsAsFile())
-                return std::nullopt;
-            juce::MemoryBlock mb;
-            if (!f.loadFileAsData(mb))
+            const auto* asset = assets.find(path);
+            if (asset == nullptr)
                 return std::nullopt;
-            juce::WebBrowserComponent::Resource r;
-            r.data.resize(mb.getSize());
-            std::memcpy(r.data.data(), mb.getData(), mb.getSize());
-            juce::String ext = f.getFileExtension().toLowerCase();
-            if (ext == ".html" || ext == ".htm")
-                r.mimeType = "text/html";
-            else if (ext == ".js")
-                r.mimeType = "application/javascript";
-            else if (ext == ".css")
-                r.mimeType = "text/css";
-            else if (ext == ".json")
-                r.mimeType = "application/json";
-            else
-                r.mimeType = "application/octet-stream";
-            return r;
+            return juce::WebBrowserComponent::Resource { asset->data, asset->mimeType };
         };
         options = options.withResourceProvider(std::move(provider), "http://localhost:5173");
     }
 #endif
 
+    // Parameters are addressed by index. Values set while the parameter is in a gesture (a slider drag) are held and applied
+    // once per refresh; anything else is applied straight away
     options = options.withNativeFunction("setParameter", [this](const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion completion)
     {
-        if (args.size() < 2)
+        const int index = args.size() >= 2 ? getWebParamIndex(args[0]) : -1;
+        if (index >= 0)
         {
-            if (completion)
-                completion(juce::var(false));
-            return;
+            const float value = juce::jlimit(0.0f, 1.0f, static_cast<float>(args[1]));
+            if (paramInGesture[static_cast<size_t>(index)])
+                pendingDragValues[index] = value;
+            else
+                webParams[static_cast<size_t>(index)]->setValueNotifyingHost(value);
         }
-        juce::String id = args[0].toString();
-        float value = static_cast<float>(args[1]);
-        auto* param = processorRef.apvts.getParameter(id);
-        if (param != nullptr)
+        if (completion)
+            completion(juce::var(index >= 0));
+    });
+
+    options = options.withNativeFunction("beginGesture", [this](const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion completion)
+    {
+        const int index = args.size() >= 1 ? getWebParamIndex(args[0]) : -1;
+        if (index >= 0)
+            beginWebGesture(index);
+        if (completion)
+            completion(juce::var(index >= 0));
+    });
+
+    options = options.withNativeFunction("endGesture", [this](const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion completion)
+    {
+        const int index = args.size() >= 1 ? getWebParamIndex(args[0]) : -1;
+        if (index >= 0)
+            endWebGesture(index);
+        if (completion)
+            completion(juce::var(index >= 0));
+    });
+
+    // Bulk edit: setParameters([[index, value], ...]) applies every value as one gesture and
+    // one audio-thread update (pattern fills, lane copies)
+    options = options.withNativeFunction("setParameters", [this](const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion completion)
+    {
+        std::vector<std::pair<int, float>> changes;
+        if (const auto* updates = args.size() > 0 ? args[0].getArray() : nullptr)
         {
-            param->setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, value));
-            if (completion)
-                completion(juce::var(true));
+            changes.reserve(static_cast<size_t>(updates->size()));
+            for (const auto& update : *updates)
+                if (const auto* pair = update.getArray(); pair != nullptr && pair->size() >= 2)
+                    changes.emplace_back(static_cast<int>((*pair)[0]), static_cast<float>((*pair)[1]));
         }
-        else if (completion)
-            completion(juce::var(false));
+
+        processorRef.setParametersAsBatch(changes);
+        if (completion)
+            completion(juce::var(static_cast<int>(changes.size())));
     });
 
-    options = options.withNativeFunction("getState", [this](const juce::Array<juce::var>&, juce::WebBrowserComponent::NativeFunctionCompletion completion)
+    // Delta state: { version, changes: [[index, value], ...] } with every parameter changed
+    // after the given version (0 for all of them). The page caches what it got, so a reload
+    // or reopened editor only fetches what changed in the meantime.
+    options = options.withNativeFunction("getStateSince", [this](const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion completion)
     {
+        const auto sinceVersion = args.size() > 0 ? static_cast<juce::int64>(args[0]) : juce::int64(0);
+
+        juce::Array<int> changedIndices;
+        const auto version = processorRef.getParametersChangedSince(static_cast<juce::uint64>(juce::jmax(juce::int64(0), sinceVersion)), changedIndices);
+
+        const auto& params = processorRef.getParameters();
+        juce::Array<juce::var> changes;
+        changes.ensureStorageAllocated(changedIndices.size());
+        for (auto index : changedIndices)
+            changes.add(juce::var(juce::Array<juce::var> { juce::var(index), juce::var(params[index]->getValue()) }));
+
         juce::DynamicObject::Ptr obj = new juce::DynamicObject();
-        auto& apvtsRef = processorRef.apvts;
-        for (const auto& id : getParamIds())
-        {
-            if (auto* param = apvtsRef.getParameter(id))
-                obj->setProperty(juce::Identifier(id), param->getValue());
-        }
+        obj->setProperty("version", static_cast<juce::int64>(version));
+        obj->setProperty("changes", changes);
         if (completion)
             completion(juce::var(obj.get()));
     });
@@ -245,6 +245,45 @@ EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
             completion(juce::var(true));
     });
 
+    options = options.withNativeFunction("setPerformanceMonitoring", [this](const juce::Array<juce::var>& args, juce::WebBrowserComponent::NativeFunctionCompletion completion)
+    {
+        auto& monitor = processorRef.getPerformanceMonitor();
+        monitor.requestReset();
+        monitor.setEnabled(args.size() > 0 && static_cast<bool>(args[0]));
+        if (completion)
+            completion(juce::var(monitor.isEnabled()));
+    });
+
+    options = options.withNativeFunction("getPerformanceStats", [this](const juce::Array<juce::var>&, juce::WebBrowserComponent::NativeFunctionCompletion completion)
+    {
+        using Stage = PerformanceMonitor::Stage;
+        const auto snapshot = processorRef.getPerformanceMonitor().getSnapshot();
+
+        juce::DynamicObject::Ptr stages = new juce::DynamicObject();
+        stages->setProperty("parameters", snapshot.getAverageStageNanosPerBlock(Stage::Parameters));
+        stages->setProperty("render", snapshot.getAverageStageNanosPerBlock(Stage::Render));
+        stages->setProperty("gain", snapshot.getAverageStageNanosPerBlock(Stage::Gain));
+        stages->setProperty("scope", snapshot.getAverageStageNanosPerBlock(Stage::Scope));
+
+        juce::Array<juce::var> histogram;
+        for (auto count : snapshot.histogram)
+            histogram.add(static_cast<int>(count));
+
+        juce::DynamicObject::Ptr obj = new juce::DynamicObject();
+        obj->setProperty("enabled", snapshot.enabled);
+        obj->setProperty("blocks", static_cast<juce::int64>(snapshot.blocks));
+        obj->setProperty("load", snapshot.getLoad());
+        obj->setProperty("avgNsPerSample", snapshot.getAverageNanosPerSample());
+        obj->setProperty("p50NsPerSample", snapshot.getNanosPerSamplePercentile(0.5));
+        obj->setProperty("p99NsPerSample", snapshot.getNanosPerSamplePercentile(0.99));
+        obj->setProperty("maxNsPerSample", snapshot.maxNanosPerSample);
+        obj->setProperty("overruns", static_cast<juce::int64>(snapshot.overruns));
+        obj->setProperty("stageNsPerBlock", juce::var(stages.get()));
+        obj->setProperty("histogram", histogram);
+        if (completion)
+            completion(juce::var(obj.get()));
+    });
+
     webBrowser = std::make_unique<juce::WebBrowserComponent>(options);
     addAndMakeVisible(webBrowser.get());
 
@@ -252,6 +291,11 @@ EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
     // Transparent WebView overlay for smooth envelope (Windows only; macOS uses native drawn envelope)
     juce::WebBrowserComponent::Options overlayOptions = options.withWinWebView2Options(
         options.getWinWebView2BackendOptions().withBackgroundColour(juce::Colours::transparent));
+    // A (re)loaded overlay page has no lanes yet: send all of them with the next frame
+    overlayOptions = overlayOptions.withEventListener("envelopeOverlayReady", [this](const juce::var&)
+    {
+        overlayNeedsFullFrame = true;
+    });
     auto overlayWrapper = std::make_unique<TransparentWebViewWrapper>(overlayOptions);
     envelopeOverlayBrowser = overlayWrapper->getBrowser();
     envelopeOverlayHolder = std::move(overlayWrapper);
@@ -264,7 +308,7 @@ EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
 
     const bool useDevEnv = juce::SystemStats::getEnvironmentVariable("ENVGEN_WEB_DEV", {}).equalsIgnoreCase("1");
 #if JUCE_WEB_BROWSER_RESOURCE_PROVIDER_AVAILABLE
-    const bool haveEmbedded = guiRootDir.exists();
+    const bool haveEmbedded = guiAssets.isAvailable();
 #else
     const bool haveEmbedded = false;
 #endif
@@ -280,13 +324,19 @@ EnvGenEditorWeb::EnvGenEditorWeb(EnvGenAudioProcessor& p)
 
 EnvGenEditorWeb::~EnvGenEditorWeb()
 {
+    // A page closed mid-drag never sends endGesture: land the last value and close it here
+    for (int i = 0; i < numWebParams; ++i)
+        if (paramInGesture[static_cast<size_t>(i)])
+            endWebGesture(i);
+
     if (oscilloscope != nullptr)
         oscilloscope->setEnvelopeOverlayCallback(nullptr);
+    refreshDriver.removeClient(oscilloscope.get());
+    refreshDriver.removeClient(this);
     processorRef.setScopeSink(nullptr);
     envelopeOverlayBrowser = nullptr;
-    auto& apvts = processorRef.apvts;
-    for (const auto& id : getParamIds())
-        apvts.removeParameterListener(id, this);
+    for (int i = 0; i < juce::jmin(processorRef.getParameters().size(), numWebParams); ++i)
+        processorRef.getParameters()[i]->removeListener(this);
 }
 
 void EnvGenEditorWeb::paint(juce::Graphics& g)
@@ -330,30 +380,96 @@ void EnvGenEditorWeb::resized()
         webBrowser->setBounds(bounds);
 }
 
-void EnvGenEditorWeb::parameterChanged(const juce::String& parameterID, float newValue)
+void EnvGenEditorWeb::parameterValueChanged(int parameterIndex, float newValue)
+{
+    // newValue is already normalised, which is what the page works in
+    if (!juce::isPositiveAndBelow(parameterIndex, numWebParams))
+        return;
+
+    pendingParamValues[static_cast<size_t>(parameterIndex)].store(newValue, std::memory_order_relaxed);
+    dirtyParamWords[static_cast<size_t>(parameterIndex >> 5)].fetch_or(juce::uint32(1) << (parameterIndex & 31), std::memory_order_release);
+}
+
+int EnvGenEditorWeb::getWebParamIndex(const juce::var& index) const
+{
+    if (!(index.isInt() || index.isInt64() || index.isDouble()))
+        return -1;
+
+    const int i = static_cast<int>(index);
+    return (juce::isPositiveAndBelow(i, numWebParams) && webParams[static_cast<size_t>(i)] != nullptr) ? i : -1;
+}
+
+void EnvGenEditorWeb::beginWebGesture(int index)
+{
+    if (paramInGesture[static_cast<size_t>(index)])
+        return;
+    paramInGesture[static_cast<size_t>(index)] = true;
+    webParams[static_cast<size_t>(index)]->beginChangeGesture();
+}
+
+void EnvGenEditorWeb::endWebGesture(int index)
+{
+    if (!paramInGesture[static_cast<size_t>(index)])
+        return;
+
+    // The final value of the drag goes to the host inside the gesture
+    const auto pending = pendingDragValues.find(index);
+    if (pending != pendingDragValues.end())
+    {
+        webParams[static_cast<size_t>(index)]->setValueNotifyingHost(pending->second);
+        pendingDragValues.erase(pending);
+    }
+
+    paramInGesture[static_cast<size_t>(index)] = false;
+    webParams[static_cast<size_t>(index)]->endChangeGesture();
+}
+
+void EnvGenEditorWeb::applyPendingDragValues()
 {
-    (void) newValue;
-    if (auto* param = processorRef.apvts.getParameter(parameterID))
-        pushParameterToWeb(parameterID, param->getValue());
+    for (const auto& [index, value] : pendingDragValues)
+        webParams[static_cast<size_t>(index)]->setValueNotifyingHost(value);
+    pendingDragValues.clear();
 }
 
-juce::String EnvGenEditorWeb::escapeJsString(const juce::String& s)
+bool EnvGenEditorWeb::wantsActiveRate() const
 {
-    juce::String out;
-    for (juce::juce_wchar c : s)
+    if (!pendingDragValues.empty())
+        return true;
+    for (const auto& word : dirtyParamWords)
+        if (word.load(std::memory_order_relaxed) != 0)
+            return true;
+    return false;
+}
+
+void EnvGenEditorWeb::refresh()
+{
+    applyPendingDragValues();
+
+    if (webBrowser == nullptr)
+        return;
+
+    // One script per refresh, however many parameters changed: [[index, value], ...]
+    juce::String updates;
+    for (size_t word = 0; word < dirtyParamWords.size(); ++word)
     {
-        if (c == '\\')
-            out << "\\\\";
-        else if (c == '\'')
-            out << "\\'";
-        else if (c == '\n')
-            out << "\\n";
-        else if (c == '\r')
-            out << "\\r";
-        else
-            out << c;
+        auto bits = dirtyParamWords[word].exchange(0, std::memory_order_acquire);
+        for (int bit = 0; bits != 0; ++bit, bits >>= 1)
+        {
+            if ((bits & 1) == 0)
+                continue;
+
+            const auto index = static_cast<int>(word) * 32 + bit;
+            const float value = pendingParamValues[static_cast<size_t>(index)].load(std::memory_order_relaxed);
+            updates << (updates.isEmpty() ? "[" : ",") << "[" << index << "," << juce::String(value) << "]";
+        }
     }
-    return out;
+
+    if (updates.isEmpty())
+        return;
+
+    juce::String script = "if (window.__ENVGEN__ && typeof window.__ENVGEN__.updateParams === 'function') { window.__ENVGEN__.updateParams("
+        + updates + "]); }";
+    webBrowser->evaluateJavascript(script, nullptr);
 }
 
 juce::String EnvGenEditorWeb::laneColourToCssRgba(juce::Colour c)
@@ -366,43 +482,53 @@ void EnvGenEditorWeb::pushEnvelopesToOverlay(const float* const* buffers, const
 {
     if (envelopeOverlayBrowser == nullptr || numLanes <= 0 || buffers == nullptr || sizes == nullptr || colours == nullptr)
         return;
+    numLanes = juce::jmin(numLanes, kMaxEnvelopeLanes);
     int w = (envelopeOverlayHolder != nullptr) ? envelopeOverlayHolder->getWidth() : 0;
     int h = (envelopeOverlayHolder != nullptr) ? envelopeOverlayHolder->getHeight() : 0;
-    juce::String lanesJson = "[";
-    bool firstLane = true;
+
+    // The scope hands over smoothed lanes. Each goes out as one base64 Float32Array, and only
+    // when it differs from what the overlay already has; a frame with no changes isn't sent
+    juce::Array<juce::var> changedLanes;
     for (int lane = 0; lane < numLanes; ++lane)
     {
-        int size = sizes[lane];
+        const int size = (buffers[lane] != nullptr) ? juce::jmax(0, sizes[lane]) : 0;
         const float* data = buffers[lane];
-        if (size <= 0 || data == nullptr)
+        auto& sent = overlaySentLanes[static_cast<size_t>(lane)];
+
+        const bool unchanged = !overlayNeedsFullFrame
+                            && static_cast<int>(sent.size()) == size
+                            && std::equal(sent.begin(), sent.end(), data)
+                            && overlaySentColours[static_cast<size_t>(lane)] == colours[lane];
+        if (unchanged)
             continue;
-        if (!firstLane)
-            lanesJson << ",";
-        firstLane = false;
-        juce::String pointsStr = "[";
-        for (int i = 0; i < size; ++i)
-        {
-            if (i > 0)
-                pointsStr << ",";
-            pointsStr << juce::String(data[i]);
-        }
-        pointsStr << "]";
-        juce::String colorStr = laneColourToCssRgba(colours[lane]);
-        lanesJson << "{\"points\":" << pointsStr << ",\"color\":\"" << colorStr.replace("\"", "\\\"") << "\"}";
+
+        // Same size every frame, so this reuses the lane's storage
+        sent.assign(data, data + size);
+        overlaySentColours[static_cast<size_t>(lane)] = colours[lane];
+
+        juce::DynamicObject::Ptr laneObj = new juce::DynamicObject();
+        laneObj->setProperty("index", lane);
+        laneObj->setProperty("color", laneColourToCssRgba(colours[lane]));
+        if (!sent.empty())
+            laneObj->setProperty("points", juce::Base64::toBase64(sent.data(), sent.size() * sizeof(float)));
+        changedLanes.add(juce::var(laneObj.get()));
     }
-    lanesJson << "]";
-    juce::String script = "if (window.__ENVGEN__ && typeof window.__ENVGEN__.drawEnvelopes === 'function') { window.__ENVGEN__.drawEnvelopes("
-        + lanesJson + ", " + juce::String(w) + ", " + juce::String(h) + "); }";
-    envelopeOverlayBrowser->evaluateJavascript(script, nullptr);
-}
 
-void EnvGenEditorWeb::pushParameterToWeb(const juce::String& id, float normalisedValue)
-{
-    if (webBrowser == nullptr)
+    const bool layoutChanged = numLanes != overlaySentNumLanes || w != overlaySentWidth || h != overlaySentHeight;
+    if (changedLanes.isEmpty() && !layoutChanged && !overlayNeedsFullFrame)
         return;
-    juce::String script = "if (window.__ENVGEN__ && typeof window.__ENVGEN__.updateParams === 'function') { window.__ENVGEN__.updateParams('"
-        + escapeJsString(id) + "', " + juce::String(normalisedValue) + "); }";
-    webBrowser->evaluateJavascript(script, nullptr);
+
+    overlayNeedsFullFrame = false;
+    overlaySentNumLanes = numLanes;
+    overlaySentWidth = w;
+    overlaySentHeight = h;
+
+    juce::DynamicObject::Ptr frame = new juce::DynamicObject();
+    frame->setProperty("numLanes", numLanes);
+    frame->setProperty("width", w);
+    frame->setProperty("height", h);
+    frame->setProperty("lanes", changedLanes);
+    envelopeOverlayBrowser->emitEventIfBrowserIsVisible("envelopeFrame", juce::var(frame.get()));
 }
 
 #endif
@@ -5,13 +5,20 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_gui_extra/juce_gui_extra.h>
 #include "PluginProcessor.h"
+#include "GuiAssetCache.h"
 #include "Components/OscilloscopeComponent.h"
+#include "Components/RefreshDriver.h"
+#include <array>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 
 //==============================================================================
 // Web-based plugin editor: native oscilloscope + WebBrowserComponent (setParameter, getState).
 // Used when ENVGEN_USE_WEB_GUI is ON; otherwise PluginEditor (native) is used.
 class EnvGenEditorWeb : public juce::AudioProcessorEditor,
-                        public juce::AudioProcessorValueTreeState::Listener
+                        private juce::AudioProcessorParameter::Listener,
+                        private RefreshDriver::Client
 {
 public:
     explicit EnvGenEditorWeb(EnvGenAudioProcessor&);
@@ -19,22 +26,60 @@ public:
 
     void paint(juce::Graphics&) override;
     void resized() override;
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    // The page addresses parameters by their ParameterTable index
+    static constexpr int numWebParams = EnvGenAudioProcessor::Params::numParameters;
 
 private:
     EnvGenAudioProcessor& processorRef;
     std::unique_ptr<OsciloscopeComponent> oscilloscope;
     std::unique_ptr<juce::WebBrowserComponent> webBrowser;
-    juce::File guiRootDir;
+    const GuiAssetCache& guiAssets;
 
     std::unique_ptr<juce::Component> envelopeOverlayHolder;
     juce::WebBrowserComponent* envelopeOverlayBrowser = nullptr;
     bool overlayTransparencyApplied = false;
 
-    void pushParameterToWeb(const juce::String& id, float value);
+    // What the overlay page is currently drawing (smoothed lanes), so unchanged lanes aren't resent
+    std::array<std::vector<float>, kMaxEnvelopeLanes> overlaySentLanes;
+    std::array<juce::Colour, kMaxEnvelopeLanes> overlaySentColours;
+    int overlaySentNumLanes = 0;
+    int overlaySentWidth = 0;
+    int overlaySentHeight = 0;
+    bool overlayNeedsFullFrame = true;
+
+    // Parameter changes waiting for the page: the latest normalised value per parameter and
+    // a dirty bit, both lock-free. refresh() sends everything dirty as one updateParams call.
+    std::array<juce::RangedAudioParameter*, numWebParams> webParams {};
+    std::array<std::atomic<float>, numWebParams> pendingParamValues {};
+    std::array<std::atomic<juce::uint32>, (numWebParams + 31) / 32> dirtyParamWords {};
+
+    // Slider drags from the page: beginGesture/endGesture bracket them, and the values sent
+    // in between are held here (the latest per parameter) and applied once per refresh
+    std::array<bool, numWebParams> paramInGesture {};
+    std::unordered_map<int, float> pendingDragValues;
+
+    // Index argument from the page, or -1 if it isn't a parameter
+    int getWebParamIndex(const juce::var& index) const;
+    void beginWebGesture(int index);
+    void endWebGesture(int index);
+    void applyPendingDragValues();
+
+    // juce::AudioProcessorParameter::Listener. Any thread (hosts automate from the audio
+    // thread): only marks the parameter dirty.
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int, bool) override {}
+
+    // RefreshDriver::Client: applies held drag values and flushes parameter changes to the
+    // page, at the full rate while either is pending
+    void refresh() override;
+    bool wantsActiveRate() const override;
+
+    // Paces the scope, the overlay and parameter pushes; declared last so it goes first
+    RefreshDriver refreshDriver { *this };
+
     void tryApplyOverlayTransparency();
     void pushEnvelopesToOverlay(const float* const* buffers, const int* sizes, int numLanes, const juce::Colour* colours);
-    static juce::String escapeJsString(const juce::String& s);
     static juce::String laneColourToCssRgba(juce::Colour c);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EnvGenEditorWeb)
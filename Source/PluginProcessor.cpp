@@ -8,45 +8,132 @@
 */
 
 #include "PluginProcessor.h"
-#include "Components/OscilloscopeComponent.h"
-#if ENVGEN_USE_WEB_GUI
+#include <algorithm>
+#if ENVGEN_HEADLESS
+// EnvGenRender: no editor is compiled in
+#elif ENVGEN_USE_WEB_GUI
 #include "PluginEditorWeb.h"
 #else
 #include "PluginEditor.h"
 #endif
 
+namespace
+{
+    // Volume gain: Dry OFF = silence until envelope; Dry ON = dry at unity, envelope adds on top.
+    // Positive modulation is scaled by 3 and negative modulation pulls down from the base gain.
+    // Written without branches so the loop vectorizes; input/output gain are folded into the
+    // result so each channel is only touched once per block.
+    void modulationToGain(float* data, int numSamples, float baseGain, float staticGain)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float modulation = data[i];
+            const float gain = baseGain + 3.0f * juce::jmax(modulation, 0.0f) + juce::jmin(modulation, 0.0f);
+            data[i] = juce::jmax(0.0f, gain) * staticGain;
+        }
+    }
+
+    // Playhead position numSamples into the block (for blocks rendered in several chunks).
+    // A host loop that ends inside the block wraps the position back by whole loop lengths,
+    // as StepSequencer::scheduleBlock does within a chunk (a start past the loop end, or a
+    // loop shorter than a sample, plays straight on).
+    juce::AudioPlayHead::PositionInfo advancePosition(juce::AudioPlayHead::PositionInfo info, int numSamples, double sampleRate)
+    {
+        if (auto ppq = info.getPpqPosition())
+        {
+            if (auto bpm = info.getBpm(); bpm && *bpm > 0.0 && sampleRate > 0.0)
+            {
+                const double samplesPerBeat = sampleRate * 60.0 / *bpm;
+                double advanced = *ppq + numSamples / samplesPerBeat;
+
+                if (auto loopPoints = info.getLoopPoints(); loopPoints && info.getIsLooping())
+                {
+                    const double loopLength = loopPoints->ppqEnd - loopPoints->ppqStart;
+                    if (loopLength * samplesPerBeat >= 1.0 && *ppq < loopPoints->ppqEnd && advanced >= loopPoints->ppqEnd)
+                        advanced = loopPoints->ppqStart + std::fmod(advanced - loopPoints->ppqEnd, loopLength);
+                }
+
+                info.setPpqPosition(advanced);
+            }
+        }
+
+        if (auto timeInSamples = info.getTimeInSamples())
+            info.setTimeInSamples(*timeInSamples + numSamples);
+
+        return info;
+    }
+}
+
 //==============================================================================
 EnvGenAudioProcessor::EnvGenAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
                      .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
+    // Parameters are created in ParameterTable order, so pointers are fetched by index
+    const auto& allParams = getParameters();
+    jassert(allParams.size() == Params::numParameters);
+
+   #if JUCE_DEBUG
+    for (int i = 0; i < allParams.size(); ++i)
+        if (auto* withId = dynamic_cast<juce::AudioProcessorParameterWithID*>(allParams[i]))
+            jassert(withId->getParameterID() == Params::getParameterId(i));
+   #endif
+
+    auto getParam = [&allParams](int index) { return allParams[index]; };
+
     // Get global parameter pointers
-    inputGainParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("inputGain"));
-    outputGainParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("outputGain"));
-    dryPassParam = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter("dryPass"));
-    numLanesParam = dynamic_cast<juce::AudioParameterInt*>(apvts.getParameter("numLanes"));
+    inputGainParam = dynamic_cast<juce::AudioParameterFloat*>(getParam(Params::inputGain));
+    outputGainParam = dynamic_cast<juce::AudioParameterFloat*>(getParam(Params::outputGain));
+    dryPassParam = dynamic_cast<juce::AudioParameterBool*>(getParam(Params::dryPass));
+    numLanesParam = dynamic_cast<juce::AudioParameterInt*>(getParam(Params::numLanes));
 
-    // Get per-lane parameter pointers (lanes 1..8)
+    // Get per-lane parameter pointers (lanes 1..NUM_LANES)
+    using Slot = Params::LaneSlot;
     for (int lane = 0; lane < NUM_LANES; ++lane)
     {
-        juce::String prefix = "lane" + juce::String(lane + 1);
         for (int step = 0; step < NUM_STEPS; ++step)
-        {
-            juce::String paramName = prefix + "_step" + juce::String(step);
-            laneParams[lane].steps[step] = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(paramName));
-        }
-        laneParams[lane].attack = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(prefix + "_attack"));
-        laneParams[lane].hold = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(prefix + "_hold"));
-        laneParams[lane].decay = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(prefix + "_decay"));
-        laneParams[lane].amount = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(prefix + "_amount"));
-        laneParams[lane].rate = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(prefix + "_rate"));
-        laneParams[lane].destination = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(prefix + "_destination"));
+            laneParams[lane].steps[step] = dynamic_cast<juce::AudioParameterBool*>(getParam(Params::getStepIndex(lane, step)));
+
+        laneParams[lane].attack = dynamic_cast<juce::AudioParameterFloat*>(getParam(Params::getLaneSlotIndex(lane, Slot::attack)));
+        laneParams[lane].hold = dynamic_cast<juce::AudioParameterFloat*>(getParam(Params::getLaneSlotIndex(lane, Slot::hold)));
+        laneParams[lane].decay = dynamic_cast<juce::AudioParameterFloat*>(getParam(Params::getLaneSlotIndex(lane, Slot::decay)));
+        laneParams[lane].amount = dynamic_cast<juce::AudioParameterFloat*>(getParam(Params::getLaneSlotIndex(lane, Slot::amount)));
+        laneParams[lane].rate = dynamic_cast<juce::AudioParameterChoice*>(getParam(Params::getLaneSlotIndex(lane, Slot::rate)));
+        laneParams[lane].destination = dynamic_cast<juce::AudioParameterChoice*>(getParam(Params::getLaneSlotIndex(lane, Slot::destination)));
     }
+
+    // Every parameter starts at version 1 and is listened to for version bumps
+    numParameterVersions = getParameters().size();
+    parameterVersions = std::make_unique<std::atomic<juce::uint64>[]>(static_cast<size_t>(numParameterVersions));
+    for (int i = 0; i < numParameterVersions; ++i)
+        parameterVersions[static_cast<size_t>(i)].store(1);
+
+    // Route lane parameter changes into the shared per-lane snapshots
+    parameterTargets.resize(static_cast<size_t>(getParameters().size()));
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+    {
+        auto& params = laneParams[lane];
+        for (int step = 0; step < NUM_STEPS; ++step)
+            addLaneParameterTarget(params.steps[step], lane, SharedLaneParameters::Field::Step, step);
+        addLaneParameterTarget(params.attack, lane, SharedLaneParameters::Field::Attack);
+        addLaneParameterTarget(params.hold, lane, SharedLaneParameters::Field::Hold);
+        addLaneParameterTarget(params.decay, lane, SharedLaneParameters::Field::Decay);
+        addLaneParameterTarget(params.amount, lane, SharedLaneParameters::Field::Amount);
+        addLaneParameterTarget(params.rate, lane, SharedLaneParameters::Field::Rate);
+        addLaneParameterTarget(params.destination, lane, SharedLaneParameters::Field::Destination);
+    }
+
+    // Lane parameters got their listener above; the global ones only need versioning
+    for (auto* param : getParameters())
+        if (parameterTargets[static_cast<size_t>(param->getParameterIndex())].lane < 0)
+            param->addListener(this);
 }
 
 EnvGenAudioProcessor::~EnvGenAudioProcessor()
 {
+    for (auto* param : getParameters())
+        param->removeListener(this);
 }
 
 //==============================================================================
@@ -101,21 +188,28 @@ void EnvGenAudioProcessor::changeProgramName(int /*index*/, const juce::String&
 //==============================================================================
 void EnvGenAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Prepare envelopes and sequencers
+    // Prepare envelopes, sequencers and the per-lane block buffers
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    preparedSampleRate = sampleRate;
+    laneRenderer.prepare(sampleRate, maxBlockSize);
+
+    // Re-apply every lane's parameters to the freshly prepared DSP
     for (int i = 0; i < NUM_LANES; ++i)
     {
-        envelopes[i].prepare(sampleRate);
-        sequencers[i].prepare(sampleRate);
+        const auto version = sharedLaneParams[i].getVersion();
+        applyLaneSnapshot(i, sharedLaneParams[i].load(), version);
     }
 
-    // Initialize from parameters for all active lanes
-    const int n = numLanesParam != nullptr ? numLanesParam->get() : 0;
-    for (int i = 0; i < n && i < NUM_LANES; ++i)
-        updateLaneFromParams(i);
-
     // Allocate temporary buffers for oscilloscope data
-    monoBuffer.resize(static_cast<size_t>(samplesPerBlock));
-    envelopeBuffer.resize(static_cast<size_t>(samplesPerBlock));
+    const int samplesPerPoint = ScopeDataSink::getSamplesPerPoint(sampleRate);
+    monoBuffer.resize(static_cast<size_t>(maxBlockSize));
+    scopeAudioDecimator.prepare(samplesPerPoint, maxBlockSize);
+    for (auto& decimator : scopeEnvelopeDecimators)
+        decimator.prepare(samplesPerPoint, maxBlockSize);
+
+    // processBlock isn't running, so the sink can't be swapped or fed while it resizes
+    if (auto* sink = scopeSink.load())
+        sink->prepare(sampleRate, maxBlockSize, scopeMaxMeasureSeconds);
 }
 
 void EnvGenAudioProcessor::releaseResources()
@@ -137,6 +231,12 @@ bool EnvGenAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) co
 void EnvGenAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    PerformanceMonitor::BlockScope perf(performanceMonitor, buffer.getNumSamples(), getSampleRate());
+
+    // Hold the scope sink for the whole block: the render loop feeds it chunk by chunk
+    scopeSinkInUse.store(true);
+    auto* const sink = scopeSink.load();
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -144,9 +244,9 @@ void EnvGenAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // Apply input gain
-    float inputGainLinear = juce::Decibels::decibelsToGain(inputGainParam->get());
-    buffer.applyGain(inputGainLinear);
+    const float inputGainLinear = juce::Decibels::decibelsToGain(inputGainParam->get());
+    const float outputGainLinear = juce::Decibels::decibelsToGain(outputGainParam->get());
+    const float baseGain = dryPassParam->get() ? 1.0f : 0.0f;
 
     // Get playhead info
     juce::AudioPlayHead::PositionInfo positionInfo;
@@ -157,62 +257,21 @@ void EnvGenAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
             positionInfo = *pos;
     }
 
-    const int numActiveLanes = (numLanesParam != nullptr) ? numLanesParam->get() : 0;
+    // Pick up lane parameters that changed since the last block (a batch edit lands whole, in
+    // one block); lanes not assigned to Amplitude contribute nothing
+    updateLanesFromParams();
+    const int numActiveLanes = heldNumActiveLanes;
+    float laneAmounts[NUM_LANES] = {};
+    for (int i = 0; i < numActiveLanes; ++i)
+        laneAmounts[i] = laneSnapshots[i].getAmplitudeAmount();
 
-    // Update parameters for active lanes only
-    for (int i = 0; i < numActiveLanes && i < NUM_LANES; ++i)
-        updateLaneFromParams(i);
+    perf.endStage(PerformanceMonitor::Stage::Parameters);
 
     const int numSamples = buffer.getNumSamples();
     const int numChannels = buffer.getNumChannels();
 
-    // Process sample by sample for accurate envelope/sequencer timing
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        float volumeModulation = 0.0f;
-
-        if (numActiveLanes > 0)
-        {
-            for (int lane = 0; lane < numActiveLanes && lane < NUM_LANES; ++lane)
-            {
-                if (sequencers[lane].process(positionInfo))
-                    envelopes[lane].trigger();
-
-                float envValue = envelopes[lane].process();
-                if (laneParams[lane].destination != nullptr && laneParams[lane].destination->getIndex() == 1) // Amplitude
-                {
-                    float amount = laneParams[lane].amount->get();
-                    volumeModulation += envValue * amount;
-                }
-            }
-        }
-
-        // Volume gain: Dry OFF = silence until envelope; Dry ON = dry at unity, envelope adds on top
-        bool dryPass = dryPassParam->get();
-        float baseGain = dryPass ? 1.0f : 0.0f;
-        float volumeGain;
-        if (volumeModulation > 0.0f)
-            volumeGain = baseGain + volumeModulation * 3.0f;  // envelope adds on top
-        else if (volumeModulation < 0.0f)
-            volumeGain = baseGain + volumeModulation;          // can pull down from base
-        else
-            volumeGain = baseGain;                             // no envelope: 0 or 1
-        volumeGain = juce::jmax(0.0f, volumeGain);
-
-        // Apply volume modulation to each channel
-        for (int channel = 0; channel < numChannels; ++channel)
-        {
-            float* channelData = buffer.getWritePointer(channel);
-            channelData[sample] *= volumeGain;
-        }
-    }
-
-    // Apply output gain
-    float outputGainLinear = juce::Decibels::decibelsToGain(outputGainParam->get());
-    buffer.applyGain(outputGainLinear);
-
-    // Push data to scope sink if connected
-    if (scopeSink != nullptr)
+    // The block's playhead goes to the scope ahead of its points
+    if (sink != nullptr)
     {
         // Convert PositionInfo to CurrentPositionInfo for scope
         juce::AudioPlayHead::CurrentPositionInfo currentPosInfo;
@@ -232,38 +291,130 @@ void EnvGenAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
             currentPosInfo.timeSigDenominator = timeSigOpt->denominator;
         }
         
-        scopeSink->updatePlayheadInfo(currentPosInfo);
-        
-        for (int sample = 0; sample < numSamples; ++sample)
+        sink->updatePlayheadInfo(currentPosInfo);
+    }
+
+    // Render the lanes block-wise into the modulation buffer, turn it into a gain curve
+    // and apply it to every channel in one pass (hosts may exceed the prepared block size)
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        const int blockSize = juce::jmin(maxBlockSize, numSamples - start);
+
+        laneRenderer.process(start == 0 ? positionInfo : advancePosition(positionInfo, start, getSampleRate()),
+                             numActiveLanes, laneAmounts, blockSize);
+        perf.endStage(PerformanceMonitor::Stage::Render);
+
+        // No amplitude lane running or firing: the output is known ahead of time. Silence with
+        // Dry off, the static gain (or nothing at all at unity) with Dry on.
+        if (laneRenderer.getModulatedLanes() == 0)
         {
-            float monoSample = 0.0f;
+            const float staticGain = baseGain * inputGainLinear * outputGainLinear;
+
+            if (staticGain == 0.0f && start == 0 && blockSize == numSamples)
+                buffer.clear();
+            else if (staticGain != 1.0f)
+                buffer.applyGain(start, blockSize, staticGain);
+        }
+        else
+        {
+            float* gain = laneRenderer.getModulationBuffer();
+            modulationToGain(gain, blockSize, baseGain, inputGainLinear * outputGainLinear);
+
             for (int channel = 0; channel < numChannels; ++channel)
-            {
-                monoSample += buffer.getSample(channel, sample);
-            }
-            monoSample /= static_cast<float>(numChannels);
-            monoBuffer[static_cast<size_t>(sample)] = juce::jlimit(-1.0f, 1.0f, monoSample);
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, start), gain, blockSize);
         }
-        scopeSink->pushBuffer(monoBuffer.data(), numSamples);
+        perf.endStage(PerformanceMonitor::Stage::Gain);
 
-        for (int lane = 0; lane < numActiveLanes && lane < NUM_LANES; ++lane)
+        // Each chunk's scope points go out before the next chunk renders, so the decimators
+        // never hold more than one prepared block's worth
+        if (sink != nullptr)
         {
-            for (int sample = 0; sample < numSamples; ++sample)
-                envelopeBuffer[static_cast<size_t>(sample)] = juce::jlimit(0.0f, 1.0f, envelopes[lane].getCurrentValue());
-            scopeSink->pushEnvelopeBuffer(envelopeBuffer.data(), numSamples, lane);
+            pushScopeChunk(*sink, buffer, start, blockSize, numActiveLanes);
+            perf.endStage(PerformanceMonitor::Stage::Scope);
         }
     }
+
+    scopeSinkInUse.store(false);
+}
+
+void EnvGenAudioProcessor::pushScopeChunk(ScopeDataSink& sink, const juce::AudioBuffer<float>& buffer,
+                                          int start, int numSamples, int numActiveLanes)
+{
+    // Decimate each lane's real per-sample envelope. Every lane is fed (silent ones without a
+    // scan) so all decimators stay in step.
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+    {
+        if (((laneRenderer.getActiveLanes() >> lane) & 1u) != 0)
+            scopeEnvelopeDecimators[lane].process(laneRenderer.getLaneBuffer(lane), numSamples);
+        else
+            scopeEnvelopeDecimators[lane].processSilence(numSamples);
+    }
+
+    // Mono mix of the output, reduced to min/max points
+    const int numChannels = buffer.getNumChannels();
+    if (numChannels == 0)
+    {
+        scopeAudioDecimator.processSilence(numSamples);
+    }
+    else
+    {
+        float* mono = monoBuffer.data();
+        juce::FloatVectorOperations::copy(mono, buffer.getReadPointer(0, start), numSamples);
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::add(mono, buffer.getReadPointer(channel, start), numSamples);
+        if (numChannels > 1)
+            juce::FloatVectorOperations::multiply(mono, 1.0f / static_cast<float>(numChannels), numSamples);
+
+        scopeAudioDecimator.process(mono, numSamples);
+    }
+
+    // The decimators ran in step, so every lane has as many points as the audio
+    const int numPoints = scopeAudioDecimator.getNumPoints();
+    for (int first = 0; first < numPoints; first += ScopeDataSink::maxPointsPerPush)
+    {
+        const int chunkPoints = juce::jmin(ScopeDataSink::maxPointsPerPush, numPoints - first);
+        sink.pushAudioPoints(scopeAudioDecimator.getMinima() + first, scopeAudioDecimator.getMaxima() + first, chunkPoints);
+
+        for (int lane = 0; lane < numActiveLanes; ++lane)
+        {
+            jassert(scopeEnvelopeDecimators[lane].getNumPoints() == numPoints);
+            sink.pushEnvelopePoints(scopeEnvelopeDecimators[lane].getMaxima() + first, chunkPoints, lane);
+        }
+    }
+
+    scopeAudioDecimator.clearPoints();
+    for (auto& decimator : scopeEnvelopeDecimators)
+        decimator.clearPoints();
+}
+
+void EnvGenAudioProcessor::setScopeSink(ScopeDataSink* sink)
+{
+    // Sized here, before the audio thread can reach it
+    if (sink != nullptr && preparedSampleRate > 0.0)
+        sink->prepare(preparedSampleRate, maxBlockSize, scopeMaxMeasureSeconds);
+
+    // Both sides use sequentially consistent operations: either processBlock sees the new
+    // sink, or this sees processBlock's flag and waits for its (short, lock-free) pushes
+    scopeSink.store(sink);
+    while (scopeSinkInUse.load())
+        juce::Thread::yield();
 }
 
 //==============================================================================
 bool EnvGenAudioProcessor::hasEditor() const
 {
+#if ENVGEN_HEADLESS
+    return false;
+#else
     return true;
+#endif
 }
 
 juce::AudioProcessorEditor* EnvGenAudioProcessor::createEditor()
 {
-#if ENVGEN_USE_WEB_GUI
+#if ENVGEN_HEADLESS
+    return nullptr;
+#elif ENVGEN_USE_WEB_GUI
     return new EnvGenEditorWeb(*this);
 #else
     return new EnvGenAudioProcessorEditor(*this);
@@ -295,7 +446,7 @@ void EnvGenAudioProcessor::setStateInformation(const void* data, int sizeInBytes
 int EnvGenAudioProcessor::getCurrentStep(int laneIndex) const
 {
     if (laneIndex >= 0 && laneIndex < NUM_LANES)
-        return sequencers[laneIndex].getCurrentStep();
+        return laneRenderer.getSequencer(laneIndex).getCurrentStep();
     return 0;
 }
 
@@ -309,41 +460,173 @@ void EnvGenAudioProcessor::resetAllParametersToDefault()
     }
 }
 
-//==============================================================================
-juce::ParameterID EnvGenAudioProcessor::getStepParamID(int laneIndex, int stepIndex)
+void EnvGenAudioProcessor::setParametersAsBatch(const std::vector<std::pair<int, float>>& changes)
 {
-    if (laneIndex < 0 || laneIndex >= NUM_LANES || stepIndex < 0 || stepIndex >= NUM_STEPS)
-        return juce::ParameterID("lane1_step0", 1);
-    juce::String id = "lane" + juce::String(laneIndex + 1) + "_step" + juce::String(stepIndex);
-    return juce::ParameterID(id, 1);
+    // Message thread only: batches don't nest, so the sequence is odd exactly while one is open
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    // Stage the batch first: valid indices only, one entry per parameter (the last value
+    // wins), so every parameter gets exactly one gesture
+    const auto& params = getParameters();
+    std::vector<std::pair<int, float>> staged;
+    staged.reserve(changes.size());
+    for (const auto& [index, value] : changes)
+    {
+        if (!juce::isPositiveAndBelow(index, params.size()))
+            continue;
+
+        const auto normalised = juce::jlimit(0.0f, 1.0f, value);
+        auto existing = std::find_if(staged.begin(), staged.end(), [index = index](const auto& change) { return change.first == index; });
+        if (existing != staged.end())
+            existing->second = normalised;
+        else
+            staged.emplace_back(index, normalised);
+    }
+
+    if (staged.empty())
+        return;
+
+    for (const auto& [index, value] : staged)
+        params[index]->beginChangeGesture();
+
+    // Odd from here until every value is published, then even again in one step
+    parameterBatchSequence.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (const auto& [index, value] : staged)
+        params[index]->setValueNotifyingHost(value);
+
+    parameterBatchSequence.fetch_add(1, std::memory_order_release);
+
+    for (const auto& [index, value] : staged)
+        params[index]->endChangeGesture();
 }
 
 //==============================================================================
-void EnvGenAudioProcessor::updateLaneFromParams(int laneIndex)
+void EnvGenAudioProcessor::addLaneParameterTarget(juce::AudioProcessorParameter* param, int laneIndex,
+                                                  SharedLaneParameters::Field field, int stepIndex)
 {
-    if (laneIndex < 0 || laneIndex >= NUM_LANES)
+    if (param == nullptr)
         return;
 
-    auto& params = laneParams[laneIndex];
-    auto& envelope = envelopes[laneIndex];
-    auto& sequencer = sequencers[laneIndex];
+    const int index = param->getParameterIndex();
+    if (!juce::isPositiveAndBelow(index, static_cast<int>(parameterTargets.size())))
+        return;
+
+    parameterTargets[static_cast<size_t>(index)] = { laneIndex, field, stepIndex };
+    publishLaneParameter(index);
+    param->addListener(this);
+}
+
+void EnvGenAudioProcessor::publishLaneParameter(int parameterIndex)
+{
+    const auto& target = parameterTargets[static_cast<size_t>(parameterIndex)];
+    auto& shared = sharedLaneParams[target.lane];
+    auto& params = laneParams[target.lane];
 
-    // Update envelope parameters
-    envelope.setAttack(params.attack->get());
-    envelope.setHold(params.hold->get());
-    envelope.setDecay(params.decay->get());
+    switch (target.field)
+    {
+        case SharedLaneParameters::Field::Step:        shared.setStep(target.step, params.steps[target.step]->get()); break;
+        case SharedLaneParameters::Field::Attack:      shared.setFloat(target.field, params.attack->get()); break;
+        case SharedLaneParameters::Field::Hold:        shared.setFloat(target.field, params.hold->get()); break;
+        case SharedLaneParameters::Field::Decay:       shared.setFloat(target.field, params.decay->get()); break;
+        case SharedLaneParameters::Field::Amount:      shared.setFloat(target.field, params.amount->get()); break;
+        case SharedLaneParameters::Field::Rate:        shared.setChoice(target.field, params.rate->getIndex()); break;
+        case SharedLaneParameters::Field::Destination: shared.setChoice(target.field, params.destination->getIndex()); break;
+    }
+}
 
-    // Update sequencer steps
-    for (int step = 0; step < NUM_STEPS; ++step)
+void EnvGenAudioProcessor::parameterValueChanged(int parameterIndex, float /*newValue*/)
+{
+    // Called on whichever thread changed the parameter (possibly the audio thread)
+    if (juce::isPositiveAndBelow(parameterIndex, static_cast<int>(parameterTargets.size()))
+        && parameterTargets[static_cast<size_t>(parameterIndex)].lane >= 0)
+        publishLaneParameter(parameterIndex);
+
+    // The value is already stored. Marking the parameter pending before taking a version
+    // means a reader either sees the mark or reads the counter before this version exists.
+    if (juce::isPositiveAndBelow(parameterIndex, numParameterVersions))
     {
-        sequencer.setStep(step, params.steps[step]->get());
+        auto& version = parameterVersions[static_cast<size_t>(parameterIndex)];
+        version.store(kVersionPending);
+        version.store(parameterChangeCounter.fetch_add(1) + 1);
     }
+}
+
+juce::uint64 EnvGenAudioProcessor::getParametersChangedSince(juce::uint64 sinceVersion, juce::Array<int>& changedIndices) const
+{
+    // Read the counter first: anything that completes after this has a higher version and
+    // is reported next time; anything pending now is reported now (and maybe again)
+    const auto currentVersion = parameterChangeCounter.load();
+    if (sinceVersion > currentVersion)
+        sinceVersion = 0;  // not one of ours (e.g. from another instance): send everything
 
-    // Update sequencer rate
-    sequencer.setRate(static_cast<StepSequencer::Rate>(params.rate->getIndex()));
+    for (int i = 0; i < numParameterVersions; ++i)
+        if (parameterVersions[static_cast<size_t>(i)].load() > sinceVersion)
+            changedIndices.add(i);
+
+    return currentVersion;
+}
+
+void EnvGenAudioProcessor::parameterGestureChanged(int /*parameterIndex*/, bool /*gestureIsStarting*/)
+{
 }
 
 //==============================================================================
+void EnvGenAudioProcessor::updateLanesFromParams()
+{
+    const auto sequence = parameterBatchSequence.load(std::memory_order_acquire);
+    if ((sequence & 1u) != 0)
+        return;  // a batch is being written: keep what we have, it lands whole in a later block
+
+    // Stage everything that changed; nothing reaches the DSP until the read is known clean
+    const int numLanesValue = juce::jlimit(0, NUM_LANES, (numLanesParam != nullptr) ? numLanesParam->get() : 0);
+    LaneParameterSnapshot staged[NUM_LANES];
+    juce::uint32 stagedVersions[NUM_LANES] = {};
+    juce::uint32 changedLanes = 0;
+
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+    {
+        // Read the version first so a write racing with load() is picked up again next block
+        const auto version = sharedLaneParams[lane].getVersion();
+        if (version == appliedLaneVersions[lane])
+            continue;
+
+        stagedVersions[lane] = version;
+        staged[lane] = sharedLaneParams[lane].load();
+        changedLanes |= juce::uint32(1) << lane;
+    }
+
+    // A batch started (or started and finished) while we read: part of it may be in the
+    // staged values, so drop them all and try again next block
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (parameterBatchSequence.load(std::memory_order_relaxed) != sequence)
+        return;
+
+    heldNumActiveLanes = numLanesValue;
+    for (int lane = 0; lane < NUM_LANES; ++lane)
+        if (((changedLanes >> lane) & 1u) != 0)
+            applyLaneSnapshot(lane, staged[lane], stagedVersions[lane]);
+}
+
+void EnvGenAudioProcessor::applyLaneSnapshot(int laneIndex, const LaneParameterSnapshot& snapshot, juce::uint32 version)
+{
+    if (laneIndex < 0 || laneIndex >= NUM_LANES)
+        return;
+
+    appliedLaneVersions[laneIndex] = version;
+    laneSnapshots[laneIndex] = snapshot;
+
+    // Envelope coefficients are only recalculated when attack/hold/decay actually changed
+    laneRenderer.getEnvelopes().setParameters(laneIndex, snapshot.attack, snapshot.hold, snapshot.decay);
+
+    auto& sequencer = laneRenderer.getSequencer(laneIndex);
+    sequencer.setStepMask(snapshot.stepMask);
+    sequencer.setRate(static_cast<Renderer::Sequencer::Rate>(snapshot.rate));
+}
+
+//==============================================================================
+template <int NumLanes, int NumSteps>
 juce::AudioProcessorValueTreeState::ParameterLayout EnvGenAudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
@@ -362,46 +645,48 @@ juce::AudioProcessorValueTreeState::ParameterLayout EnvGenAudioProcessor::create
     layout.add(std::make_unique<juce::AudioParameterBool>(
         ::ParameterID::dryPass, "Dry", false));  // OFF = silence until envelope; ON = dry passes, envelope adds
 
-    // Number of active lanes (0..8, default 0)
+    // Number of active lanes (0..NumLanes, default 0)
     layout.add(std::make_unique<juce::AudioParameterInt>(
-        ::ParameterID::numLanes, "Lanes", 0, 8, 0));
+        ::ParameterID::numLanes, "Lanes", 0, NumLanes, 0));
 
     juce::StringArray rateChoices{ "1/1", "1/2", "1/4", "1/8", "1/16", "1/32" };
     juce::StringArray destChoices{ "None", "Amplitude" };
 
-    // Lane parameters (lanes 1..8: steps, attack, hold, decay, rate, destination, amount)
-    for (int lane = 0; lane < NUM_LANES; ++lane)
-    {
-        juce::String prefix = "lane" + juce::String(lane + 1);
+    // Lane parameters (lanes 1..NumLanes: steps, attack, hold, decay, rate, destination, amount).
+    // IDs and order come from ParameterTable, which the editors index into.
+    using Table = ParameterTable<NumLanes, NumSteps>;
+    using Slot = typename Table::LaneSlot;
+    auto laneId = [](int lane, Slot slot) { return juce::ParameterID(Table::getParameterId(Table::getLaneSlotIndex(lane, slot)), 1); };
 
-        for (int step = 0; step < NUM_STEPS; ++step)
+    for (int lane = 0; lane < NumLanes; ++lane)
+    {
+        for (int step = 0; step < NumSteps; ++step)
         {
-            juce::String stepId = prefix + "_step" + juce::String(step);
             juce::String stepName = "Step " + juce::String(step + 1);
             layout.add(std::make_unique<juce::AudioParameterBool>(
-                juce::ParameterID(stepId, 1), stepName, false));
+                juce::ParameterID(Table::getParameterId(Table::getStepIndex(lane, step)), 1), stepName, false));
         }
 
         layout.add(std::make_unique<juce::AudioParameterFloat>(
-            juce::ParameterID(prefix + "_attack", 1), "Attack",
+            laneId(lane, Slot::attack), "Attack",
             juce::NormalisableRange<float>(0.001f, 10.0f, 0.001f, 0.3f),
             0.01f, "s"));
         layout.add(std::make_unique<juce::AudioParameterFloat>(
-            juce::ParameterID(prefix + "_hold", 1), "Hold",
+            laneId(lane, Slot::hold), "Hold",
             juce::NormalisableRange<float>(0.0f, 10.0f, 0.001f, 0.3f),
             0.1f, "s"));
         layout.add(std::make_unique<juce::AudioParameterFloat>(
-            juce::ParameterID(prefix + "_decay", 1), "Decay",
+            laneId(lane, Slot::decay), "Decay",
             juce::NormalisableRange<float>(0.001f, 10.0f, 0.001f, 0.3f),
             0.5f, "s"));
         layout.add(std::make_unique<juce::AudioParameterChoice>(
-            juce::ParameterID(prefix + "_rate", 1), "Rate",
+            laneId(lane, Slot::rate), "Rate",
             rateChoices, 4));
         layout.add(std::make_unique<juce::AudioParameterChoice>(
-            juce::ParameterID(prefix + "_destination", 1), "Assign",
+            laneId(lane, Slot::destination), "Assign",
             destChoices, 0));
         layout.add(std::make_unique<juce::AudioParameterFloat>(
-            juce::ParameterID(prefix + "_amount", 1), "Amount",
+            laneId(lane, Slot::amount), "Amount",
             juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f),
             1.0f));
     }
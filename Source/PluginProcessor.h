@@ -10,8 +10,12 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "DSP/Envelope.h"
-#include "DSP/StepSequencer.h"
+#include "EnvGenConfig.h"
+#include "DSP/LaneRenderer.h"
+#include "DSP/ScopeDecimator.h"
+#include "LaneParameters.h"
+#include "ParameterTable.h"
+#include "PerformanceMonitor.h"
 #include "ScopeDataSink.h"
 
 //==============================================================================
@@ -20,30 +24,29 @@ namespace ParameterID
 {
     #define PARAMETER_ID(str) const juce::ParameterID str(#str, 1);
 
-    // Global parameters
+    // Global parameters (lane parameter IDs come from ParameterTable::getParameterId)
     PARAMETER_ID(inputGain)
     PARAMETER_ID(outputGain)
     PARAMETER_ID(dryPass)
     PARAMETER_ID(numLanes)
 
-    // Lane 1 (lane2..lane8 use getStepParamID / string IDs in layout)
-    PARAMETER_ID(lane1_step0)  PARAMETER_ID(lane1_step1)  PARAMETER_ID(lane1_step2)  PARAMETER_ID(lane1_step3)
-    PARAMETER_ID(lane1_step4)  PARAMETER_ID(lane1_step5)  PARAMETER_ID(lane1_step6)  PARAMETER_ID(lane1_step7)
-    PARAMETER_ID(lane1_step8)  PARAMETER_ID(lane1_step9)  PARAMETER_ID(lane1_step10) PARAMETER_ID(lane1_step11)
-    PARAMETER_ID(lane1_step12) PARAMETER_ID(lane1_step13) PARAMETER_ID(lane1_step14) PARAMETER_ID(lane1_step15)
-    PARAMETER_ID(lane1_attack) PARAMETER_ID(lane1_hold)   PARAMETER_ID(lane1_decay)  PARAMETER_ID(lane1_rate)
-    PARAMETER_ID(lane1_destination) PARAMETER_ID(lane1_amount)
-
     #undef PARAMETER_ID
 }
 
 //==============================================================================
-class EnvGenAudioProcessor : public juce::AudioProcessor
+class EnvGenAudioProcessor : public juce::AudioProcessor,
+                             private juce::AudioProcessorParameter::Listener
 {
 public:
     //==============================================================================
-    static constexpr int NUM_LANES = 8;
-    static constexpr int NUM_STEPS = 16;
+    // Lane/step counts are fixed per build (ENVGEN_NUM_LANES / ENVGEN_NUM_STEPS)
+    using Renderer = LaneRenderer<EnvGenConfig::numLanes, EnvGenConfig::numSteps>;
+
+    static constexpr int NUM_LANES = Renderer::NUM_LANES;
+    static constexpr int NUM_STEPS = Renderer::NUM_STEPS;
+
+    // Stable parameter indices (into getParameters()) shared by the editors and the web UI
+    using Params = ParameterTable<NUM_LANES, NUM_STEPS>;
 
     //==============================================================================
     EnvGenAudioProcessor();
@@ -81,24 +84,52 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     //==============================================================================
-    juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout() };
+    juce::AudioProcessorValueTreeState apvts{ *this, nullptr, "Parameters", createParameterLayout<NUM_LANES, NUM_STEPS>() };
 
     // Get current step for UI visualization
     int getCurrentStep(int laneIndex) const;
 
-    // Set scope data sink for waveform display (native OsciloscopeComponent or web ScopeBuffer)
-    void setScopeSink(ScopeDataSink* sink) { scopeSink = sink; }
+    // Set scope data sink for waveform display (native OsciloscopeComponent or web ScopeBuffer).
+    // Message thread; the new sink is prepared before the audio thread sees it, and once this
+    // returns the audio thread is no longer using the previous sink.
+    void setScopeSink(ScopeDataSink* sink);
+
+    // Longest measure the scope holds (e.g. 7/4 at 30 BPM)
+    static constexpr double scopeMaxMeasureSeconds = 16.0;
 
     /** Set every parameter to its default value (from createParameterLayout). */
     void resetAllParametersToDefault();
 
+    // Parameter change versions: every change takes the next version number, and each
+    // parameter remembers the version of its latest change. Version 0 comes before
+    // everything, so asking since 0 returns every parameter. Any thread.
+    juce::uint64 getParameterVersion() const { return parameterChangeCounter.load(); }
+
+    // Adds the indices (into getParameters()) changed after sinceVersion and returns the
+    // version to pass next time
+    juce::uint64 getParametersChangedSince(juce::uint64 sinceVersion, juce::Array<int>& changedIndices) const;
+
+    // Message thread: sets normalised values by parameter index (into getParameters()) as
+    // one edit. Every parameter in the batch is inside a single begin/end gesture, and the
+    // audio thread holds back lane updates until the whole batch is in, so it picks the
+    // batch up in one block. An index listed more than once takes its last value.
+    void setParametersAsBatch(const std::vector<std::pair<int, float>>& changes);
+
+    // Unique per processor instance, so editors can tell their cached state apart
+    const juce::String& getInstanceId() const { return instanceId; }
+
+    // Opt-in processBlock timing, read by the editors
+    PerformanceMonitor& getPerformanceMonitor() { return performanceMonitor; }
+
 private:
     //==============================================================================
-    juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    template <int NumLanes, int NumSteps>
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
     // DSP components
-    Envelope envelopes[NUM_LANES];
-    StepSequencer sequencers[NUM_LANES];
+    Renderer laneRenderer;
+    int maxBlockSize = 0;
+    double preparedSampleRate = 0.0;
 
     // Parameter pointers for fast access
     // Global
@@ -120,18 +151,65 @@ private:
     };
     LaneParams laneParams[NUM_LANES];
 
-    // Helper to get step parameter IDs
-    static juce::ParameterID getStepParamID(int laneIndex, int stepIndex);
-
-    // Update DSP from parameters
-    void updateLaneFromParams(int laneIndex);
+    // Lane parameters published by the parameter listener, picked up once per block
+    SharedLaneParameters sharedLaneParams[NUM_LANES];
+    LaneParameterSnapshot laneSnapshots[NUM_LANES];
+    juce::uint32 appliedLaneVersions[NUM_LANES] = {};
 
-    // Scope data sink for waveform display (owned by editor: native or web)
-    ScopeDataSink* scopeSink = nullptr;
+    // Which lane/field each parameter index feeds (lane < 0 for global parameters)
+    struct ParameterTarget
+    {
+        int lane = -1;
+        SharedLaneParameters::Field field = SharedLaneParameters::Field::Step;
+        int step = 0;
+    };
+    std::vector<ParameterTarget> parameterTargets;
+
+    // See getParametersChangedSince(). A parameter reads kVersionPending while its listener
+    // call is taking a version, so a reader never skips a change that is in flight.
+    static constexpr juce::uint64 kVersionPending = ~juce::uint64(0);
+    std::atomic<juce::uint64> parameterChangeCounter { 1 };
+    std::unique_ptr<std::atomic<juce::uint64>[]> parameterVersions;
+    int numParameterVersions = 0;
+    const juce::String instanceId { juce::Uuid().toString() };
+
+    void addLaneParameterTarget(juce::AudioProcessorParameter* param, int laneIndex,
+                                SharedLaneParameters::Field field, int stepIndex = 0);
+    void publishLaneParameter(int parameterIndex);
+
+    // juce::AudioProcessorParameter::Listener
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+
+    // Seqlock around setParametersAsBatch(): odd while a batch is being written, bumped again
+    // once it is all in. The audio thread stages what it reads and drops it if the sequence
+    // was odd or moved meanwhile, keeping the lane snapshots and lane count it already had.
+    std::atomic<juce::uint32> parameterBatchSequence { 0 };
+    int heldNumActiveLanes = 0;
+
+    // Apply changed lane snapshots and the lane count to the DSP, unless a batch edit overlaps
+    // the read (audio thread)
+    void updateLanesFromParams();
+    void applyLaneSnapshot(int laneIndex, const LaneParameterSnapshot& snapshot, juce::uint32 version);
+
+    // Scope data sink for waveform display (owned by editor: native or web). processBlock
+    // raises scopeSinkInUse around its pushes so setScopeSink can wait out a detach.
+    std::atomic<ScopeDataSink*> scopeSink { nullptr };
+    std::atomic<bool> scopeSinkInUse { false };
+
+    PerformanceMonitor performanceMonitor;
     
-    // Temporary buffers for oscilloscope data (allocated once in prepareToPlay)
+    // Oscilloscope data, reduced to min/max points on the audio thread (allocated once in
+    // prepareToPlay). Lane envelopes are decimated as each chunk renders and the mono mix
+    // after the gain; every decimator sees the same sample counts, so their points line up.
     std::vector<float> monoBuffer;
-    std::vector<float> envelopeBuffer;
+    ScopeDecimator scopeAudioDecimator;
+    ScopeDecimator scopeEnvelopeDecimators[NUM_LANES];
+
+    // Decimates one rendered chunk (at most maxBlockSize samples) for the scope, pushes its
+    // points and clears the decimators (audio thread)
+    void pushScopeChunk(ScopeDataSink& sink, const juce::AudioBuffer<float>& buffer,
+                        int start, int numSamples, int numActiveLanes);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EnvGenAudioProcessor)
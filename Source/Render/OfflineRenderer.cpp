@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Runs one EnvGenAudioProcessor over WAV files or synthetic input (EnvGenRender)
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+double OfflineRenderer::Stats::getRealtimeFactor() const
+{
+    if (renderSeconds <= 0.0 || sampleRate <= 0.0)
+        return 0.0;
+    return static_cast<double>(numSamples) / sampleRate / renderSeconds;
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(const Options& optionsToUse, const juce::MemoryBlock& state)
+    : options(optionsToUse)
+{
+    formatManager.registerBasicFormats();
+
+    if (state.getSize() > 0)
+        processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+    processor.setNonRealtime(true);
+    processor.setPlayHead(&playHead);
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    processor.setPlayHead(nullptr);
+}
+
+juce::Result OfflineRenderer::prepare(int numChannels, double sampleRate)
+{
+    if (numChannels < 1 || numChannels > 2)
+        return juce::Result::fail("only mono and stereo are supported (got " + juce::String(numChannels) + " channels)");
+    if (sampleRate <= 0.0)
+        return juce::Result::fail("invalid sample rate");
+
+    const auto channelSet = (numChannels == 1) ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(channelSet);
+    layout.outputBuses.add(channelSet);
+    if (!processor.setBusesLayout(layout))
+        return juce::Result::fail("processor rejected the " + channelSet.getDescription() + " layout");
+
+    // What a host does before playback: rate/size first, then prepareToPlay (which also resets the DSP)
+    processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+    processor.prepareToPlay(sampleRate, options.blockSize);
+    playHead.prepare(options.transport, sampleRate);
+
+    buffer.setSize(numChannels, options.blockSize);
+    sinePhase = 0.0;
+
+    auto& monitor = processor.getPerformanceMonitor();
+    monitor.setEnabled(options.measurePerformance);
+    monitor.requestReset();
+
+    return juce::Result::ok();
+}
+
+void OfflineRenderer::fillSynthetic(int numSamples, double sampleRate)
+{
+    float* left = buffer.getWritePointer(0);
+
+    switch (options.signal)
+    {
+        case Signal::Sine:
+        {
+            const double increment = juce::MathConstants<double>::twoPi * 110.0 / sampleRate;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                left[i] = 0.5f * static_cast<float>(std::sin(sinePhase));
+                sinePhase = std::fmod(sinePhase + increment, juce::MathConstants<double>::twoPi);
+            }
+            break;
+        }
+        case Signal::Noise:
+            for (int i = 0; i < numSamples; ++i)
+                left[i] = random.nextFloat() - 0.5f;
+            break;
+        case Signal::Dc:
+            juce::FloatVectorOperations::fill(left, 0.5f, numSamples);
+            break;
+    }
+
+    for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+        buffer.copyFrom(channel, 0, buffer, 0, 0, numSamples);
+}
+
+juce::Result OfflineRenderer::render(const Job& job, Stats& stats)
+{
+    stats = {};
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    int numChannels = options.numChannels;
+    double sampleRate = options.sampleRate;
+    juce::int64 totalSamples = 0;
+
+    if (job.input != juce::File())
+    {
+        reader.reset(formatManager.createReaderFor(job.input));
+        if (reader == nullptr)
+            return juce::Result::fail("can't read " + job.input.getFullPathName());
+
+        numChannels = static_cast<int>(reader->numChannels);
+        sampleRate = reader->sampleRate;
+        totalSamples = reader->lengthInSamples;
+    }
+    else
+    {
+        totalSamples = static_cast<juce::int64>(job.syntheticSeconds * sampleRate);
+    }
+
+    auto result = prepare(numChannels, sampleRate);
+    if (result.failed())
+        return result;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (job.output != juce::File())
+    {
+        job.output.getParentDirectory().createDirectory();
+        job.output.deleteFile();
+
+        auto stream = job.output.createOutputStream();
+        if (stream == nullptr)
+            return juce::Result::fail("can't write " + job.output.getFullPathName());
+
+        juce::WavAudioFormat wav;
+        writer.reset(wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+                                         options.bitsPerSample, {}, 0));
+        if (writer == nullptr)
+            return juce::Result::fail("can't create a " + juce::String(options.bitsPerSample) + "-bit WAV writer");
+        stream.release(); // the writer owns the stream now
+    }
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (juce::int64 position = 0; position < totalSamples;)
+    {
+        // Blocks end early at the loop end, like a host splitting its buffer at the wrap
+        const int maxSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), totalSamples - position));
+        const int numSamples = playHead.getSamplesUntilLoopEnd(maxSamples);
+        buffer.setSize(numChannels, numSamples, false, false, true);
+
+        if (reader != nullptr)
+            reader->read(&buffer, 0, numSamples, position, true, true);
+        else
+            fillSynthetic(numSamples, sampleRate);
+
+        processor.processBlock(buffer, midi);
+        playHead.advance(numSamples);
+
+        if (writer != nullptr && !writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+            return juce::Result::fail("write error on " + job.output.getFullPathName());
+
+        position += numSamples;
+    }
+
+    stats.numSamples = totalSamples;
+    stats.sampleRate = sampleRate;
+    stats.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    if (options.measurePerformance)
+        stats.performance = processor.getPerformanceMonitor().getSnapshot().getSummary();
+
+    processor.releaseResources();
+    return juce::Result::ok();
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Runs one EnvGenAudioProcessor over WAV files or synthetic input (EnvGenRender)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "SimulatedPlayHead.h"
+
+// One processor instance and everything needed to push files through it. EnvGenRender gives
+// each worker thread its own OfflineRenderer, so instances never share DSP state.
+class OfflineRenderer
+{
+public:
+    enum class Signal
+    {
+        Sine,    // 110 Hz at -6 dBFS
+        Noise,   // white noise at -6 dBFS
+        Dc       // constant 0.5: the output is the gain curve itself
+    };
+
+    struct Options
+    {
+        SimulatedPlayHead::Settings transport;
+        int blockSize = 512;
+        int bitsPerSample = 24;
+        bool measurePerformance = false;
+
+        // Synthetic input only (files use their own rate and channel count)
+        double sampleRate = 48000.0;
+        int numChannels = 2;
+        Signal signal = Signal::Sine;
+    };
+
+    struct Job
+    {
+        juce::File input;                // empty: synthetic input
+        double syntheticSeconds = 0.0;
+        juce::File output;               // empty: render without writing
+    };
+
+    struct Stats
+    {
+        juce::int64 numSamples = 0;
+        double sampleRate = 0.0;
+        double renderSeconds = 0.0;      // wall-clock time spent in the render loop
+        juce::String performance;        // PerformanceMonitor summary if requested
+
+        double getRealtimeFactor() const;
+    };
+
+    // Create on the message thread (the parameter tree starts a timer there). state is a blob
+    // as written by getStateInformation(); empty keeps the default parameters.
+    OfflineRenderer(const Options& options, const juce::MemoryBlock& state);
+    ~OfflineRenderer();
+
+    // Not thread-safe: each instance renders one job at a time
+    juce::Result render(const Job& job, Stats& stats);
+
+private:
+    const Options options;
+
+    EnvGenAudioProcessor processor;
+    SimulatedPlayHead playHead;
+    juce::AudioFormatManager formatManager;
+
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    juce::Random random;
+    double sinePhase = 0.0;
+
+    juce::Result prepare(int numChannels, double sampleRate);
+    void fillSynthetic(int numSamples, double sampleRate);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
@@ -0,0 +1,299 @@
+/*
+  ==============================================================================
+
+    RenderMain.cpp
+    EnvGenRender: headless batch renderer for the envelope generator
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace
+{
+    const char* const usage =
+        "Usage: EnvGenRender [options] <input.wav> [more inputs...]\n"
+        "       EnvGenRender [options] --synthetic <seconds>\n"
+        "\n"
+        "Input and output\n"
+        "  --state <file>        plugin state: a getStateInformation() blob or its XML\n"
+        "  --out <dir>           output folder (default: next to each input)\n"
+        "  --no-write            render without writing files (benchmarking)\n"
+        "  --bits <16|24|32>     output bit depth (default 24, 32 = float)\n"
+        "\n"
+        "Synthetic input\n"
+        "  --synthetic <seconds> render generated input instead of files\n"
+        "  --signal <sine|noise|dc>  (default sine; dc writes the gain curve itself)\n"
+        "  --count <n>           number of synthetic renders (default 1)\n"
+        "  --sample-rate <hz>    (default 48000)\n"
+        "  --channels <1|2>      (default 2)\n"
+        "\n"
+        "Transport\n"
+        "  --bpm <bpm>           (default 120)\n"
+        "  --time-sig <n/d>      (default 4/4)\n"
+        "  --start <ppq>         start position in quarter notes (default 0)\n"
+        "  --loop <start:end>    loop between two positions in quarter notes\n"
+        "  --block-size <n>      samples per processBlock call (default 512)\n"
+        "\n"
+        "  --jobs <n>            worker threads, one processor each (default: all cores)\n"
+        "  --perf                print processBlock timing for every render\n";
+
+    int fail(const juce::String& message)
+    {
+        std::fprintf(stderr, "EnvGenRender: %s\n", message.toRawUTF8());
+        return 1;
+    }
+
+    // Accepts the binary blob the plugin stores in host sessions, or the same state as XML
+    juce::Result loadState(const juce::File& file, juce::MemoryBlock& state)
+    {
+        if (!file.existsAsFile() || !file.loadFileAsData(state))
+            return juce::Result::fail("can't read state file " + file.getFullPathName());
+
+        std::unique_ptr<juce::XmlElement> xml;
+        if (state.toString().trimStart().startsWithChar('<'))
+        {
+            xml = juce::parseXML(file);
+            if (xml != nullptr)
+            {
+                state.reset();
+                juce::AudioProcessor::copyXmlToBinary(*xml, state);
+            }
+        }
+        else
+        {
+            xml = juce::AudioProcessor::getXmlFromBinary(state.getData(), static_cast<int>(state.getSize()));
+        }
+
+        if (xml == nullptr || !xml->hasTagName("Parameters"))
+            return juce::Result::fail(file.getFullPathName() + " is not an Envelope Generator state");
+
+        return juce::Result::ok();
+    }
+
+    juce::Result parseTransport(const juce::ArgumentList& args, SimulatedPlayHead::Settings& transport)
+    {
+        if (args.containsOption("--bpm"))
+            transport.bpm = args.getValueForOption("--bpm").getDoubleValue();
+        if (transport.bpm <= 0.0)
+            return juce::Result::fail("--bpm must be positive");
+
+        if (args.containsOption("--time-sig"))
+        {
+            const auto timeSig = args.getValueForOption("--time-sig");
+            transport.timeSigNumerator = timeSig.upToFirstOccurrenceOf("/", false, false).getIntValue();
+            transport.timeSigDenominator = timeSig.fromFirstOccurrenceOf("/", false, false).getIntValue();
+            if (transport.timeSigNumerator <= 0 || !juce::isPowerOfTwo(transport.timeSigDenominator))
+                return juce::Result::fail("--time-sig expects n/d, e.g. 7/8");
+        }
+
+        if (args.containsOption("--start"))
+            transport.startPpq = args.getValueForOption("--start").getDoubleValue();
+
+        if (args.containsOption("--loop"))
+        {
+            const auto loop = args.getValueForOption("--loop");
+            transport.loopStartPpq = loop.upToFirstOccurrenceOf(":", false, false).getDoubleValue();
+            transport.loopEndPpq = loop.fromFirstOccurrenceOf(":", false, false).getDoubleValue();
+            if (!transport.isLooping() || transport.loopStartPpq < 0.0)
+                return juce::Result::fail("--loop expects start:end in quarter notes with end > start");
+        }
+
+        return juce::Result::ok();
+    }
+
+    //==============================================================================
+    // Shared between the workers: the job list, the next job to take and the outcome
+    struct Batch
+    {
+        std::vector<OfflineRenderer::Job> jobs;
+        std::atomic<int> nextJob { 0 };
+        std::atomic<int> numFailed { 0 };
+        juce::CriticalSection printLock;
+
+        void report(const OfflineRenderer::Job& job, const juce::Result& result, const OfflineRenderer::Stats& stats)
+        {
+            const auto name = (job.input != juce::File()) ? job.input.getFileName() : juce::String("synthetic");
+            const juce::ScopedLock sl(printLock);
+
+            if (result.failed())
+            {
+                std::fprintf(stderr, "FAILED %s: %s\n", name.toRawUTF8(), result.getErrorMessage().toRawUTF8());
+                return;
+            }
+
+            std::printf("%s: %.1f s of audio in %.3f s (%.0fx realtime)%s%s\n",
+                        name.toRawUTF8(),
+                        static_cast<double>(stats.numSamples) / stats.sampleRate,
+                        stats.renderSeconds,
+                        stats.getRealtimeFactor(),
+                        job.output != juce::File() ? " -> " : "",
+                        job.output != juce::File() ? job.output.getFullPathName().toRawUTF8() : "");
+
+            if (stats.performance.isNotEmpty())
+                std::printf("    %s\n", stats.performance.toRawUTF8());
+            std::fflush(stdout);
+        }
+    };
+
+    // One per pool thread: takes jobs until the list is exhausted, always with its own processor
+    class RenderWorker : public juce::ThreadPoolJob
+    {
+    public:
+        RenderWorker(Batch& batchToUse, OfflineRenderer& rendererToUse)
+            : juce::ThreadPoolJob("EnvGenRender worker"), batch(batchToUse), renderer(rendererToUse)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            for (int index = batch.nextJob++; index < static_cast<int>(batch.jobs.size()); index = batch.nextJob++)
+            {
+                if (shouldExit())
+                    break;
+
+                const auto& job = batch.jobs[static_cast<size_t>(index)];
+                OfflineRenderer::Stats stats;
+                const auto result = renderer.render(job, stats);
+                if (result.failed())
+                    ++batch.numFailed;
+
+                batch.report(job, result, stats);
+            }
+            return jobHasFinished;
+        }
+
+    private:
+        Batch& batch;
+        OfflineRenderer& renderer;
+    };
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // The processor's parameter tree needs a message manager, even without a message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args(argc, argv);
+    if (args.size() == 0 || args.containsOption("--help|-h"))
+    {
+        std::printf("%s", usage);
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    OfflineRenderer::Options options;
+    if (auto result = parseTransport(args, options.transport); result.failed())
+        return fail(result.getErrorMessage());
+
+    if (args.containsOption("--block-size"))
+        options.blockSize = args.getValueForOption("--block-size").getIntValue();
+    if (options.blockSize < 1)
+        return fail("--block-size must be at least 1");
+
+    if (args.containsOption("--bits"))
+        options.bitsPerSample = args.getValueForOption("--bits").getIntValue();
+    if (options.bitsPerSample != 16 && options.bitsPerSample != 24 && options.bitsPerSample != 32)
+        return fail("--bits must be 16, 24 or 32");
+
+    if (args.containsOption("--sample-rate"))
+        options.sampleRate = args.getValueForOption("--sample-rate").getDoubleValue();
+    if (args.containsOption("--channels"))
+        options.numChannels = args.getValueForOption("--channels").getIntValue();
+
+    if (args.containsOption("--signal"))
+    {
+        const auto signal = args.getValueForOption("--signal");
+        if (signal == "sine")        options.signal = OfflineRenderer::Signal::Sine;
+        else if (signal == "noise")  options.signal = OfflineRenderer::Signal::Noise;
+        else if (signal == "dc")     options.signal = OfflineRenderer::Signal::Dc;
+        else                         return fail("unknown --signal " + signal);
+    }
+
+    options.measurePerformance = args.containsOption("--perf");
+
+    juce::MemoryBlock state;
+    if (args.containsOption("--state"))
+        if (auto result = loadState(args.getFileForOption("--state"), state); result.failed())
+            return fail(result.getErrorMessage());
+
+    const bool writeOutput = !args.containsOption("--no-write");
+    const auto outputFolder = args.containsOption("--out") ? args.getFileForOption("--out") : juce::File();
+
+    // Build the job list
+    Batch batch;
+
+    if (args.containsOption("--synthetic"))
+    {
+        const double seconds = args.getValueForOption("--synthetic").getDoubleValue();
+        const int count = args.containsOption("--count") ? args.getValueForOption("--count").getIntValue() : 1;
+        if (seconds <= 0.0 || count < 1)
+            return fail("--synthetic needs a positive length and --count at least 1");
+
+        const auto folder = (outputFolder != juce::File()) ? outputFolder : juce::File::getCurrentWorkingDirectory();
+        for (int i = 0; i < count; ++i)
+        {
+            OfflineRenderer::Job job;
+            job.syntheticSeconds = seconds;
+            if (writeOutput)
+                job.output = folder.getChildFile("synthetic_" + juce::String(i + 1) + "_envgen.wav");
+            batch.jobs.push_back(job);
+        }
+    }
+
+    // Everything that is neither an option nor an option's value is an input file
+    const juce::StringArray valueOptions { "--state", "--out", "--bits", "--synthetic", "--signal", "--count",
+                                           "--sample-rate", "--channels", "--bpm", "--time-sig", "--start",
+                                           "--loop", "--block-size", "--jobs" };
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i].isOption())
+        {
+            if (valueOptions.contains(args[i].text))
+                ++i;
+            continue;
+        }
+
+        OfflineRenderer::Job job;
+        job.input = args[i].resolveAsFile();
+        if (writeOutput)
+        {
+            const auto folder = (outputFolder != juce::File()) ? outputFolder : job.input.getParentDirectory();
+            job.output = folder.getChildFile(job.input.getFileNameWithoutExtension() + "_envgen.wav");
+        }
+        batch.jobs.push_back(job);
+    }
+
+    if (batch.jobs.empty())
+        return fail("nothing to render (give input files or --synthetic)");
+
+    const int numJobs = static_cast<int>(batch.jobs.size());
+    const int requestedWorkers = args.containsOption("--jobs") ? args.getValueForOption("--jobs").getIntValue()
+                                                               : juce::SystemStats::getNumCpus();
+    const int numWorkers = juce::jlimit(1, numJobs, requestedWorkers);
+
+    // Processors are created (and destroyed) here on the message thread; the workers only render
+    std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+    for (int i = 0; i < numWorkers; ++i)
+        renderers.push_back(std::make_unique<OfflineRenderer>(options, state));
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    {
+        juce::ThreadPool pool(numWorkers);
+        for (auto& renderer : renderers)
+            pool.addJob(new RenderWorker(batch, *renderer), true);
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(10);
+    }
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    std::printf("%d of %d renders done in %.3f s on %d worker%s\n",
+                numJobs - batch.numFailed.load(), numJobs, elapsed, numWorkers, numWorkers == 1 ? "" : "s");
+
+    return batch.numFailed.load() == 0 ? 0 : 1;
+}
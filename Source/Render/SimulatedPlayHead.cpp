@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    SimulatedPlayHead.cpp
+    Host transport for offline rendering: fixed tempo, time signature and loop
+
+  ==============================================================================
+*/
+
+#include "SimulatedPlayHead.h"
+
+void SimulatedPlayHead::prepare(const Settings& newSettings, double newSampleRate)
+{
+    settings = newSettings;
+    sampleRate = newSampleRate;
+    ppqPerSample = (sampleRate > 0.0) ? settings.bpm / (60.0 * sampleRate) : 0.0;
+
+    ppqPosition = settings.startPpq;
+    timeInSamples = 0;
+}
+
+int SimulatedPlayHead::getSamplesUntilLoopEnd(int maxSamples) const
+{
+    if (!settings.isLooping() || ppqPerSample <= 0.0 || ppqPosition >= settings.loopEndPpq)
+        return juce::jmax(1, maxSamples);
+
+    const double samplesLeft = std::ceil((settings.loopEndPpq - ppqPosition) / ppqPerSample);
+    return juce::jlimit(1, juce::jmax(1, maxSamples), static_cast<int>(juce::jmin(samplesLeft, static_cast<double>(maxSamples))));
+}
+
+void SimulatedPlayHead::advance(int numSamples)
+{
+    const double previousPpq = ppqPosition;
+    ppqPosition += numSamples * ppqPerSample;
+    timeInSamples += numSamples;
+
+    // Jump back by whole loop lengths, keeping the overshoot (a start before the loop plays into it first)
+    if (settings.isLooping() && previousPpq < settings.loopEndPpq && ppqPosition >= settings.loopEndPpq)
+    {
+        const double loopLength = settings.loopEndPpq - settings.loopStartPpq;
+        ppqPosition = settings.loopStartPpq + std::fmod(ppqPosition - settings.loopEndPpq, loopLength);
+    }
+}
+
+juce::Optional<juce::AudioPlayHead::PositionInfo> SimulatedPlayHead::getPosition() const
+{
+    PositionInfo info;
+    info.setIsPlaying(true);
+    info.setBpm(settings.bpm);
+    info.setTimeSignature(TimeSignature { settings.timeSigNumerator, settings.timeSigDenominator });
+    info.setPpqPosition(ppqPosition);
+    info.setTimeInSamples(timeInSamples);
+    info.setTimeInSeconds(static_cast<double>(timeInSamples) / sampleRate);
+
+    // Bar starts assume the time signature holds from ppq 0
+    const double quarterNotesPerBar = settings.timeSigNumerator * 4.0 / settings.timeSigDenominator;
+    if (quarterNotesPerBar > 0.0)
+    {
+        const double bar = std::floor(ppqPosition / quarterNotesPerBar);
+        info.setBarCount(static_cast<juce::int64>(bar));
+        info.setPpqPositionOfLastBarStart(bar * quarterNotesPerBar);
+    }
+
+    info.setIsLooping(settings.isLooping());
+    if (settings.isLooping())
+        info.setLoopPoints(LoopPoints { settings.loopStartPpq, settings.loopEndPpq });
+
+    return info;
+}
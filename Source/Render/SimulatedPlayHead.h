@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    SimulatedPlayHead.h
+    Host transport for offline rendering: fixed tempo, time signature and loop
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Plays the role of a DAW transport for EnvGenRender. The render loop asks how many samples
+// may be processed before the next loop wrap, processes them, then advances the playhead, so
+// blocks are split at the loop end the way hosts split them.
+class SimulatedPlayHead : public juce::AudioPlayHead
+{
+public:
+    struct Settings
+    {
+        double bpm = 120.0;
+        int timeSigNumerator = 4;
+        int timeSigDenominator = 4;
+        double startPpq = 0.0;
+
+        // Loop in quarter notes; disabled unless loopEndPpq > loopStartPpq
+        double loopStartPpq = 0.0;
+        double loopEndPpq = 0.0;
+
+        bool isLooping() const { return loopEndPpq > loopStartPpq; }
+    };
+
+    SimulatedPlayHead() = default;
+    ~SimulatedPlayHead() override = default;
+
+    // Rewinds to settings.startPpq
+    void prepare(const Settings& newSettings, double newSampleRate);
+
+    // Samples until the loop wraps, at most maxSamples (and at least 1)
+    int getSamplesUntilLoopEnd(int maxSamples) const;
+
+    void advance(int numSamples);
+
+    // juce::AudioPlayHead
+    juce::Optional<PositionInfo> getPosition() const override;
+
+private:
+    Settings settings;
+    double sampleRate = 44100.0;
+    double ppqPerSample = 0.0;
+
+    double ppqPosition = 0.0;
+    juce::int64 timeInSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimulatedPlayHead)
+};
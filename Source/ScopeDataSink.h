@@ -14,26 +14,37 @@
 
 //==============================================================================
 /** Interface for receiving scope data from the audio processor.
-    The processor pushes mono audio, envelope values, and playhead info each block.
+    Each block the processor pushes playhead info, then decimated mono audio and the
+    decimated envelope of each lane (in chunks of at most maxPointsPerPush points). Both streams are reduced on the audio thread to
+    one point per getSamplesPerPoint() samples, so a measure is a few thousand points.
 */
 class ScopeDataSink
 {
 public:
     virtual ~ScopeDataSink() = default;
 
-    /** Add mono audio samples for the current measure. */
-    virtual void pushBuffer(const float* samples, int numSamples) = 0;
+    /** Called by prepareToPlay and whenever the sink is attached, never from the audio
+        thread. Size all storage here: the push methods must not allocate. A measure longer
+        than maxMeasureSeconds may be cut short. */
+    virtual void prepare(double sampleRate, int maxBlockSize, double maxMeasureSeconds) = 0;
 
-    /** Add envelope values (0..1) aligned with the audio buffer. */
-    virtual void pushEnvelopeBuffer(const float* samples, int numSamples) = 0;
+    /** Add decimated mono audio for the current measure: the minimum and maximum of each
+        group of getSamplesPerPoint() samples. */
+    virtual void pushAudioPoints(const float* minima, const float* maxima, int numPoints) = 0;
 
-    /** Add envelope values for a specific lane (0..7). Default: only lane 0 is forwarded to pushEnvelopeBuffer(samples, numSamples). */
-    virtual void pushEnvelopeBuffer(const float* samples, int numSamples, int laneIndex)
-    {
-        if (laneIndex == 0)
-            pushEnvelopeBuffer(samples, numSamples);
-    }
+    /** Add the decimated envelope (peak of each group, 0..1) of a lane, aligned with the
+        audio points pushed just before. */
+    virtual void pushEnvelopePoints(const float* peaks, int numPoints, int laneIndex) = 0;
 
     /** Update playhead (BPM, PPQ, time sig) for measure-boundary detection. */
     virtual void updatePlayheadInfo(const juce::AudioPlayHead::CurrentPositionInfo& info) = 0;
+
+    /** Points are pushed in chunks of at most this many, so a sink can buffer a fixed amount. */
+    static constexpr int maxPointsPerPush = 256;
+
+    /** Scope resolution: about a thousand points per second, whatever the sample rate. */
+    static int getSamplesPerPoint(double sampleRate)
+    {
+        return juce::jmax(1, juce::roundToInt(sampleRate / 1000.0));
+    }
 };
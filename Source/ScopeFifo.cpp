@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    ScopeFifo.cpp
+    Wait-free single-producer/single-consumer transport for scope data
+
+  ==============================================================================
+*/
+
+#include "ScopeFifo.h"
+
+// AbstractFifo keeps one slot free to tell full from empty
+ScopeFifo::ScopeFifo(int valueCapacity, int recordCapacity)
+    : valueFifo(valueCapacity + 1),
+      recordFifo(recordCapacity + 1),
+      valueStorage(static_cast<size_t>(valueCapacity + 1), 0.0f),
+      recordStorage(static_cast<size_t>(recordCapacity + 1))
+{
+}
+
+void ScopeFifo::setCapacity(int valueCapacity, int recordCapacity)
+{
+    valueFifo.setTotalSize(valueCapacity + 1);
+    recordFifo.setTotalSize(recordCapacity + 1);
+    valueStorage.assign(static_cast<size_t>(valueCapacity + 1), 0.0f);
+    recordStorage.assign(static_cast<size_t>(recordCapacity + 1), Record());
+    overflowed.store(false, std::memory_order_release);
+}
+
+bool ScopeFifo::pushAudio(const float* minima, const float* maxima, int numPoints)
+{
+    Record record;
+    record.type = RecordType::Audio;
+    record.numPoints = numPoints;
+    record.numValues = 2 * numPoints;
+    return push(record, minima, maxima);
+}
+
+bool ScopeFifo::pushEnvelope(const float* peaks, int numPoints, int laneIndex)
+{
+    Record record;
+    record.type = RecordType::Envelope;
+    record.laneIndex = laneIndex;
+    record.numPoints = numPoints;
+    record.numValues = numPoints;
+    return push(record, peaks, nullptr);
+}
+
+bool ScopeFifo::pushPlayhead(const juce::AudioPlayHead::CurrentPositionInfo& info)
+{
+    Record record;
+    record.type = RecordType::Playhead;
+    record.playhead = info;
+    return push(record, nullptr, nullptr);
+}
+
+bool ScopeFifo::push(const Record& record, const float* first, const float* second)
+{
+    if (overflowed.load(std::memory_order_acquire))
+        return false;
+
+    // All or nothing: a record whose values or header don't fit is dropped whole
+    if (valueFifo.getFreeSpace() < record.numValues || recordFifo.getFreeSpace() < 1)
+    {
+        overflowed.store(true, std::memory_order_release);
+        return false;
+    }
+
+    if (first != nullptr)
+        writeValues(first, record.numPoints);
+    if (second != nullptr)
+        writeValues(second, record.numPoints);
+
+    int start1, size1, start2, size2;
+    recordFifo.prepareToWrite(1, start1, size1, start2, size2);
+    recordStorage[static_cast<size_t>(size1 > 0 ? start1 : start2)] = record;
+    recordFifo.finishedWrite(1);
+    return true;
+}
+
+void ScopeFifo::writeValues(const float* values, int numValues)
+{
+    if (numValues <= 0)
+        return;
+
+    int start1, size1, start2, size2;
+    valueFifo.prepareToWrite(numValues, start1, size1, start2, size2);
+    std::copy(values, values + size1, valueStorage.begin() + start1);
+    std::copy(values + size1, values + size1 + size2, valueStorage.begin() + start2);
+    valueFifo.finishedWrite(size1 + size2);
+}
+
+int ScopeFifo::drain(Reader& reader)
+{
+    // Once the flag is seen the producer has stopped writing, so draining empties the rings
+    const bool hadOverflow = overflowed.load(std::memory_order_acquire);
+
+    int numRecords = 0;
+    while (recordFifo.getNumReady() > 0)
+    {
+        int start1, size1, start2, size2;
+        recordFifo.prepareToRead(1, start1, size1, start2, size2);
+        const Record record = recordStorage[static_cast<size_t>(size1 > 0 ? start1 : start2)];
+        recordFifo.finishedRead(1);
+
+        const float* values = nullptr;
+        if (record.numValues > 0)
+        {
+            valueFifo.prepareToRead(record.numValues, start1, size1, start2, size2);
+            if (size2 == 0)
+            {
+                values = valueStorage.data() + start1;
+            }
+            else
+            {
+                if (readScratch.size() < static_cast<size_t>(record.numValues))
+                    readScratch.resize(static_cast<size_t>(record.numValues));
+                std::copy(valueStorage.begin() + start1, valueStorage.begin() + start1 + size1, readScratch.begin());
+                std::copy(valueStorage.begin() + start2, valueStorage.begin() + start2 + size2, readScratch.begin() + size1);
+                values = readScratch.data();
+            }
+        }
+
+        switch (record.type)
+        {
+            case RecordType::Audio:     reader.handleAudio(values, values + record.numPoints, record.numPoints); break;
+            case RecordType::Envelope:  reader.handleEnvelope(values, record.numPoints, record.laneIndex); break;
+            case RecordType::Playhead:  reader.handlePlayhead(record.playhead); break;
+        }
+
+        // Release the values only after the reader is done with them in place
+        if (record.numValues > 0)
+            valueFifo.finishedRead(record.numValues);
+
+        ++numRecords;
+    }
+
+    if (hadOverflow)
+    {
+        reader.handleOverflow();
+        overflowed.store(false, std::memory_order_release);
+    }
+
+    return numRecords;
+}
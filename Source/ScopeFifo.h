@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    ScopeFifo.h
+    Wait-free single-producer/single-consumer transport for scope data
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+// Carries decimated audio, per-lane envelope and playhead records from processBlock (the
+// only producer) to the scope's timer (the only consumer). Point values go through one ring
+// and the record headers through another; a header is published only after its values, so
+// the consumer never sees a partial record. Neither side ever locks or allocates on the audio
+// thread: when the consumer falls behind, the producer drops records and flags an overflow,
+// and the consumer resynchronises once it has caught up.
+class ScopeFifo
+{
+public:
+    class Reader
+    {
+    public:
+        virtual ~Reader() = default;
+
+        virtual void handlePlayhead(const juce::AudioPlayHead::CurrentPositionInfo& info) = 0;
+        virtual void handleAudio(const float* minima, const float* maxima, int numPoints) = 0;
+        virtual void handleEnvelope(const float* peaks, int numPoints, int laneIndex) = 0;
+
+        // Records after the ones just delivered were dropped; delivery resumes with the next push
+        virtual void handleOverflow() = 0;
+    };
+
+    ScopeFifo(int valueCapacity, int recordCapacity);
+    ~ScopeFifo() = default;
+
+    // Reallocates both rings and discards their contents. Neither the producer nor the
+    // consumer may be running.
+    void setCapacity(int valueCapacity, int recordCapacity);
+
+    // Producer (audio thread): wait-free; returns false if the record was dropped
+    bool pushAudio(const float* minima, const float* maxima, int numPoints);
+    bool pushEnvelope(const float* peaks, int numPoints, int laneIndex);
+    bool pushPlayhead(const juce::AudioPlayHead::CurrentPositionInfo& info);
+
+    // Consumer: delivers everything published so far, in order; returns the number of records
+    int drain(Reader& reader);
+
+private:
+    enum class RecordType
+    {
+        Audio,
+        Envelope,
+        Playhead
+    };
+
+    struct Record
+    {
+        RecordType type = RecordType::Audio;
+        int laneIndex = 0;
+        int numPoints = 0;
+        int numValues = 0;      // numPoints, or twice that for audio (minima then maxima)
+        juce::AudioPlayHead::CurrentPositionInfo playhead;
+    };
+
+    juce::AbstractFifo valueFifo;
+    juce::AbstractFifo recordFifo;
+    std::vector<float> valueStorage;
+    std::vector<Record> recordStorage;
+
+    // Set by the producer when it drops a record; it then drops everything until the consumer clears it
+    std::atomic<bool> overflowed { false };
+
+    // Consumer-side copy of a record's values when they wrap around the ring
+    std::vector<float> readScratch;
+
+    bool push(const Record& record, const float* first, const float* second);
+    void writeValues(const float* values, int numValues);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeFifo)
+};
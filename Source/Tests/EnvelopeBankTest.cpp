@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    EnvelopeBankTest.cpp
+    Checks EnvelopeBank against independent scalar Envelope objects and a per-sample reference
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DSP/Envelope.h"
+#include "DSP/EnvelopeBank.h"
+#include "EnvGenConfig.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// EnvelopeBank must produce the same output as one Envelope per lane. Both evaluate the
+// same closed form (the bank across lanes, Envelope along time), so the only differences
+// allowed are float rounding. Both are also checked against ReferenceEnvelope, the plain
+// per-sample loop the closed form replaced, to catch a mistake they might share.
+namespace
+{
+    constexpr int numLanes = EnvGenConfig::numLanes;
+    constexpr float tolerance = 1.0e-5f;
+
+    using Bank = EnvelopeBank<numLanes>;
+
+    // Accumulate-and-smooth: step the segment value by its increment each sample, land on 1 or
+    // 0 when the segment's samples are used up, then one-pole smooth, all in double. Timing
+    // follows Envelope: segment lengths are measured from the start value, and a parameter
+    // change restarts the running attack or decay from where it is.
+    class ReferenceEnvelope
+    {
+    public:
+        void prepare(double newSampleRate)
+        {
+            sampleRate = newSampleRate;
+            const float tau = static_cast<float>(0.002 * sampleRate);
+            smoothCoeff = juce::jlimit(0.0001f, 1.0f, 1.0f - std::exp(-1.0f / tau));
+            calculateCoefficients();
+        }
+
+        void setParameters(float attackTimeSeconds, float holdTimeSeconds, float decayTimeSeconds)
+        {
+            const float newAttack = juce::jmax(0.001f, attackTimeSeconds);
+            const float newHold = juce::jmax(0.0f, holdTimeSeconds);
+            const float newDecay = juce::jmax(0.001f, decayTimeSeconds);
+            if (newAttack == attackTime && newHold == holdTime && newDecay == decayTime)
+                return;
+
+            attackTime = newAttack;
+            holdTime = newHold;
+            decayTime = newDecay;
+            calculateCoefficients();
+
+            if (phase == Envelope::Phase::Hold)
+            {
+                length = juce::jmax(1, holdSamples);
+                counter = juce::jmin(counter, length - 1);
+            }
+            else if (phase != Envelope::Phase::Idle)
+            {
+                beginSegment(phase);
+            }
+        }
+
+        void trigger() { beginSegment(Envelope::Phase::Attack); }
+
+        float process()
+        {
+            switch (phase)
+            {
+                case Envelope::Phase::Idle:   value = 0.0; break;
+                case Envelope::Phase::Attack: value += attackIncrement; ++counter; break;
+                case Envelope::Phase::Hold:   value = 1.0; ++counter; break;
+                case Envelope::Phase::Decay:  value -= decayDecrement; ++counter; break;
+            }
+
+            if (phase != Envelope::Phase::Idle && counter >= length)
+            {
+                value = (phase == Envelope::Phase::Decay) ? 0.0 : 1.0;
+                beginSegment(phase == Envelope::Phase::Attack ? Envelope::Phase::Hold
+                             : phase == Envelope::Phase::Hold ? Envelope::Phase::Decay
+                             : Envelope::Phase::Idle);
+            }
+
+            smoothed += smoothCoeff * (value - smoothed);
+            return static_cast<float>(smoothed);
+        }
+
+    private:
+        double sampleRate = 44100.0;
+        float attackTime = 0.01f, holdTime = 0.1f, decayTime = 0.5f;
+        int attackSamples = 1, holdSamples = 0, decaySamples = 1;
+        double attackIncrement = 1.0, decayDecrement = 1.0;
+        double smoothCoeff = 1.0;
+
+        Envelope::Phase phase = Envelope::Phase::Idle;
+        int counter = 0;
+        int length = 0;
+        float segmentStart = 0.0f;
+        float segmentSlope = 0.0f;
+        double value = 0.0;
+        double smoothed = 0.0;
+
+        void calculateCoefficients()
+        {
+            attackSamples = juce::jmax(1, static_cast<int>(attackTime * sampleRate));
+            holdSamples = static_cast<int>(holdTime * sampleRate);
+            decaySamples = juce::jmax(1, static_cast<int>(decayTime * sampleRate));
+            attackIncrement = 1.0 / attackSamples;
+            decayDecrement = 1.0 / decaySamples;
+        }
+
+        void beginSegment(Envelope::Phase newPhase)
+        {
+            // Lengths come from the segment value in float, exactly as Envelope computes it: a
+            // retrigger on a whole-sample boundary would otherwise round either way
+            const float startValue = (phase == Envelope::Phase::Idle || counter >= length)
+                                         ? static_cast<float>(value)
+                                         : segmentStart + segmentSlope * static_cast<float>(counter);
+            value = startValue;
+            segmentStart = startValue;
+            phase = newPhase;
+            counter = 0;
+
+            switch (newPhase)
+            {
+                case Envelope::Phase::Idle:
+                    length = 0;
+                    segmentSlope = 0.0f;
+                    break;
+                case Envelope::Phase::Attack:
+                    length = juce::jlimit(1, attackSamples, static_cast<int>(std::ceil((1.0 - startValue) * attackSamples)));
+                    segmentSlope = 1.0f / static_cast<float>(attackSamples);
+                    break;
+                case Envelope::Phase::Hold:
+                    length = juce::jmax(1, holdSamples);
+                    segmentSlope = 0.0f;
+                    break;
+                case Envelope::Phase::Decay:
+                    length = juce::jlimit(1, decaySamples, static_cast<int>(std::ceil(static_cast<double>(startValue) * decaySamples)));
+                    segmentSlope = -1.0f / static_cast<float>(decaySamples);
+                    break;
+            }
+        }
+    };
+
+    struct Result
+    {
+        float maxError = 0.0f;
+        float maxReferenceError = 0.0f;
+        int failedLane = -1;
+        juce::int64 failedSample = -1;
+    };
+
+    // Random timings from very short (shorter than a block) to a few blocks long, with the
+    // occasional zero hold
+    void randomiseParameters(std::mt19937& rng, Envelope* envelopes, ReferenceEnvelope* references, Bank& bank, int lane)
+    {
+        std::uniform_real_distribution<float> time(0.0f, 0.05f);
+        std::bernoulli_distribution noHold(0.2);
+
+        const float attack = time(rng);
+        const float hold = noHold(rng) ? 0.0f : time(rng);
+        const float decay = time(rng);
+
+        envelopes[lane].setParameters(attack, hold, decay);
+        references[lane].setParameters(attack, hold, decay);
+        bank.setParameters(lane, attack, hold, decay);
+    }
+
+    Result runCase(unsigned seed, double sampleRate, int numBlocks)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> blockSize(1, 600);
+        std::uniform_int_distribution<juce::uint32> bits;
+        std::bernoulli_distribution changeParameters(0.05);
+
+        Envelope envelopes[numLanes];
+        ReferenceEnvelope references[numLanes];
+        Bank bank;
+
+        for (auto& envelope : envelopes)
+            envelope.prepare(sampleRate);
+        for (auto& reference : references)
+            reference.prepare(sampleRate);
+        bank.prepare(sampleRate);
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            randomiseParameters(rng, envelopes, references, bank, lane);
+
+        std::vector<std::vector<float>> bankOutput(numLanes, std::vector<float>(600));
+        std::vector<float> scalarOutput(600);
+        float* outputs[numLanes];
+        for (int lane = 0; lane < numLanes; ++lane)
+            outputs[lane] = bankOutput[static_cast<size_t>(lane)].data();
+
+        Result result;
+        juce::int64 position = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Sparse triggers (three random masks ANDed) so envelopes also run to the end
+            const auto triggers = bits(rng) & bits(rng) & bits(rng) & Bank::allLanes;
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                if (changeParameters(rng))
+                    randomiseParameters(rng, envelopes, references, bank, lane);
+                if (((triggers >> lane) & 1u) != 0)
+                {
+                    envelopes[lane].trigger();
+                    references[lane].trigger();
+                }
+            }
+            bank.trigger(triggers);
+
+            // Render only the lanes that aren't silent, as LaneRenderer does
+            const int numSamples = blockSize(rng);
+            const auto activeLanes = bank.getActiveMask();
+            bank.process(outputs, numSamples, activeLanes);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                envelopes[lane].process(scalarOutput.data(), numSamples);
+
+                const bool rendered = ((activeLanes >> lane) & 1u) != 0;
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float expected = scalarOutput[static_cast<size_t>(i)];
+                    const float actual = rendered ? outputs[lane][i] : 0.0f;
+                    const float reference = references[lane].process();
+                    const float error = std::abs(expected - actual);
+                    const float referenceError = juce::jmax(std::abs(reference - expected), std::abs(reference - actual));
+
+                    result.maxError = juce::jmax(result.maxError, error);
+                    result.maxReferenceError = juce::jmax(result.maxReferenceError, referenceError);
+                    if ((error > tolerance || referenceError > tolerance) && result.failedLane < 0)
+                    {
+                        result.failedLane = lane;
+                        result.failedSample = position + i;
+                    }
+                }
+            }
+
+            position += numSamples;
+        }
+
+        return result;
+    }
+}
+
+int main()
+{
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    int failures = 0;
+
+    for (unsigned seed = 1; seed <= 8; ++seed)
+    {
+        for (auto sampleRate : sampleRates)
+        {
+            const auto result = runCase(seed, sampleRate, 2000);
+            if (result.failedLane >= 0)
+            {
+                ++failures;
+                std::printf("FAIL seed %u at %.0f Hz: lane %d differs at sample %lld (max error %g, %g from the reference)\n",
+                            seed, sampleRate, result.failedLane, static_cast<long long>(result.failedSample),
+                            static_cast<double>(result.maxError), static_cast<double>(result.maxReferenceError));
+            }
+        }
+    }
+
+    std::printf("EnvelopeBank<%d> vs Envelope and reference: %s\n", numLanes, failures == 0 ? "all cases match" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -1,12 +1,23 @@
 import { useEffect, useState, useCallback, useRef } from "react";
 import {
-  getState,
   setParameter,
+  setParameters,
+  beginParameterGesture,
+  endParameterGesture,
   setEnvGenCallbacks,
   resetAllParameters,
+  getPerformanceStats,
+  setPerformanceMonitoring,
+  type ParamUpdate,
+  type PerformanceStats,
 } from "./lib/bridge";
 import {
+  NUM_LANES,
+  PARAM_INDEX,
   getParamMeta,
+  laneParamIdsForLane,
+  laneStepIds,
+  paramIdAt,
   normalizedToReal,
   realToNormalized,
   realToSliderPosition,
@@ -14,6 +25,7 @@ import {
   type ParamMeta,
 } from "./lib/params";
 import { SECTIONS } from "./lib/sections";
+import { loadState } from "./lib/stateCache";
 import { Card, CardContent, CardHeader, CardTitle } from "@/components/ui/card";
 import { Label } from "@/components/ui/label";
 import { Slider } from "@/components/ui/slider";
@@ -29,14 +41,7 @@ import {
 
 type State = Record<string, number>;
 
-function laneParamIdsForLane(laneNum: number): string[] {
-  const ids: string[] = [];
-  for (let i = 0; i < 16; i++) ids.push(`lane${laneNum}_step${i}`);
-  ids.push(`lane${laneNum}_attack`, `lane${laneNum}_hold`, `lane${laneNum}_decay`, `lane${laneNum}_rate`, `lane${laneNum}_destination`, `lane${laneNum}_amount`);
-  return ids;
-}
-
-/** Fixed palette for lane colours (index 0..7). Must match C++ OscilloscopeComponent::getLaneColour. */
+/** Fixed palette for lane colours, repeating after lane 8. Must match C++ OscilloscopeComponent::getLaneColour. */
 export const LANE_COLOURS = [
   "#00ffaa", // 0: cyan-green
   "#ff8c00", // 1: orange
@@ -64,9 +69,7 @@ function ParamControl({
   const real = normalizedToReal(meta, value);
 
   const handleChange = (newReal: number) => {
-    const n = realToNormalized(meta, newReal);
-    onChange(n);
-    setParameter(meta.id, n);
+    onChange(realToNormalized(meta, newReal));
   };
 
   if (meta.type === "bool") {
@@ -140,40 +143,44 @@ function ParamControl({
 function EnvelopeSection({
   state,
   setStateParam,
+  setStateParams,
   onDragStart,
   onDragEnd,
   getParamMeta,
 }: {
   state: State;
   setStateParam: (id: string, n: number) => void;
+  setStateParams: (changes: State) => void;
   onDragStart: (paramId: string) => void;
   onDragEnd: () => void;
   getParamMeta: (id: string) => ParamMeta | undefined;
 }) {
   const numLanesNorm = state["numLanes"] ?? 0;
-  const numLanes = Math.round(normalizedToReal(getParamMeta("numLanes") ?? { id: "", label: "", type: "float", min: 0, max: 8 }, numLanesNorm));
-  const safeNumLanes = Math.max(0, Math.min(8, numLanes));
+  const numLanes = Math.round(normalizedToReal(getParamMeta("numLanes") ?? { id: "", label: "", type: "float", min: 0, max: NUM_LANES }, numLanesNorm));
+  const safeNumLanes = Math.max(0, Math.min(NUM_LANES, numLanes));
 
   const handleAddLane = () => {
-    if (safeNumLanes >= 8) return;
+    if (safeNumLanes >= NUM_LANES) return;
     const next = safeNumLanes + 1;
-    setStateParam("numLanes", next / 8);
+    setStateParam("numLanes", next / NUM_LANES);
   };
 
   const handleRemoveLane = (removeIndex: number) => {
     if (safeNumLanes <= 0 || removeIndex < 0 || removeIndex >= safeNumLanes) return;
-    // Copy lane (j+2) -> lane (j+1) for j = removeIndex .. numLanes-2 so we read from untouched lanes
+    // Copy lane (j+2) -> lane (j+1) for j = removeIndex .. numLanes-2 so we read from untouched lanes,
+    // and send the copies with the new lane count as one edit
+    const changes: State = {};
     for (let j = removeIndex; j <= safeNumLanes - 2; j++) {
       const srcLane = j + 2;
       const destLane = j + 1;
       const srcIds = laneParamIdsForLane(srcLane);
       const destIds = laneParamIdsForLane(destLane);
       srcIds.forEach((id, idx) => {
-        const val = state[id] ?? 0;
-        setStateParam(destIds[idx], val);
+        changes[destIds[idx]] = state[id] ?? 0;
       });
     }
-    setStateParam("numLanes", (safeNumLanes - 1) / 8);
+    changes["numLanes"] = (safeNumLanes - 1) / NUM_LANES;
+    setStateParams(changes);
   };
 
   if (safeNumLanes === 0) {
@@ -194,7 +201,7 @@ function EnvelopeSection({
           variant="outline"
           size="sm"
           onClick={handleAddLane}
-          disabled={safeNumLanes >= 8}
+          disabled={safeNumLanes >= NUM_LANES}
           aria-label="Add lane"
         >
           +
@@ -205,9 +212,9 @@ function EnvelopeSection({
       </div>
       {Array.from({ length: safeNumLanes }, (_, i) => {
         const laneNum = i + 1;
-        const stepIds = Array.from({ length: 16 }, (_, s) => `lane${laneNum}_step${s}`);
+        const stepIds = laneStepIds(laneNum);
         const envIds = [`lane${laneNum}_attack`, `lane${laneNum}_hold`, `lane${laneNum}_decay`, `lane${laneNum}_rate`, `lane${laneNum}_destination`, `lane${laneNum}_amount`];
-        const laneColor = LANE_COLOURS[i] ?? LANE_COLOURS[0];
+        const laneColor = LANE_COLOURS[i % LANE_COLOURS.length];
         return (
           <div
             key={laneNum}
@@ -272,33 +279,112 @@ function EnvelopeSection({
   );
 }
 
+/** Opt-in processBlock timing readout: summary line plus the ns/sample histogram. */
+function PerformancePanel() {
+  const [enabled, setEnabled] = useState(false);
+  const [stats, setStats] = useState<PerformanceStats | null>(null);
+
+  useEffect(() => {
+    getPerformanceStats().then((s) => setEnabled(s?.enabled ?? false)).catch(() => {});
+  }, []);
+
+  useEffect(() => {
+    if (!enabled) return;
+    const id = window.setInterval(() => {
+      getPerformanceStats().then(setStats).catch(() => {});
+    }, 250);
+    return () => window.clearInterval(id);
+  }, [enabled]);
+
+  const toggle = (checked: boolean) => {
+    setEnabled(checked);
+    setStats(null);
+    setPerformanceMonitoring(checked);
+  };
+
+  const peak = stats ? Math.max(1, ...stats.histogram) : 1;
+  const lastBucket = stats ? stats.histogram.reduce((last, count, i) => (count > 0 ? i : last), 0) : 0;
+
+  return (
+    <div className="flex flex-1 items-center gap-3 text-xs text-muted-foreground">
+      <div className="flex items-center gap-2">
+        <Switch checked={enabled} onCheckedChange={toggle} />
+        <Label className="text-xs text-muted-foreground">Perf</Label>
+      </div>
+      {enabled && stats && stats.blocks > 0 ? (
+        <>
+          <span className="tabular-nums">
+            CPU {(stats.load * 100).toFixed(2)}% · avg {stats.avgNsPerSample.toFixed(1)} · p99 &lt;{" "}
+            {stats.p99NsPerSample.toFixed(0)} · max {stats.maxNsPerSample.toFixed(0)} ns/smp · overruns {stats.overruns}
+          </span>
+          <span className="tabular-nums" title="Average ns per block: parameters / render / gain / scope">
+            {[stats.stageNsPerBlock.parameters, stats.stageNsPerBlock.render, stats.stageNsPerBlock.gain, stats.stageNsPerBlock.scope]
+              .map((ns) => (ns / 1000).toFixed(1))
+              .join(" / ")}{" "}
+            µs
+          </span>
+          <div className="flex h-5 items-end gap-px" title="Blocks per ns/sample bucket (half octaves)">
+            {stats.histogram.slice(0, lastBucket + 1).map((count, i) => (
+              <div
+                key={i}
+                className="w-1 bg-accent"
+                style={{ height: `${Math.max(count > 0 ? 8 : 0, (count / peak) * 100)}%` }}
+              />
+            ))}
+          </div>
+        </>
+      ) : enabled ? (
+        <span>Waiting for audio...</span>
+      ) : null}
+    </div>
+  );
+}
+
 export default function App() {
   const [state, setState] = useState<State>({});
   const draggingParamIdRef = useRef<string | null>(null);
 
-  const updateParam = useCallback((id: string, value: number) => {
-    setState((s) => ({ ...s, [id]: value }));
-  }, []);
-
   useEffect(() => {
     setEnvGenCallbacks({
-      updateParams: (id: string, value: number) => {
-        if (id === draggingParamIdRef.current) return;
-        updateParam(id, value);
+      // One state update per batch from the plugin, skipping the parameter being dragged
+      updateParams: (updates: ParamUpdate[]) => {
+        const changed: State = {};
+        for (const [index, value] of updates) {
+          const id = paramIdAt(index);
+          if (id && id !== draggingParamIdRef.current) changed[id] = value;
+        }
+        if (Object.keys(changed).length > 0) setState((s) => ({ ...s, ...changed }));
       },
     });
-    getState().then((s) => setState(s));
-  }, [updateParam]);
+    loadState().then((s) => setState(s));
+  }, []);
 
   const setStateParam = useCallback((id: string, n: number) => {
     setState((s) => ({ ...s, [id]: n }));
-    setParameter(id, n);
+    const index = PARAM_INDEX.get(id);
+    if (index !== undefined) setParameter(index, n);
+  }, []);
+
+  const setStateParams = useCallback((changes: State) => {
+    setState((s) => ({ ...s, ...changes }));
+    const updates: ParamUpdate[] = [];
+    for (const [id, n] of Object.entries(changes)) {
+      const index = PARAM_INDEX.get(id);
+      if (index !== undefined) updates.push([index, n]);
+    }
+    if (updates.length > 0) setParameters(updates);
   }, []);
 
+  // Pointer down/up on a slider bracket a host gesture; up and leave can both fire
   const onDragStart = useCallback((paramId: string) => {
+    const index = PARAM_INDEX.get(paramId);
+    if (index === undefined) return;
     draggingParamIdRef.current = paramId;
+    beginParameterGesture(index);
   }, []);
   const onDragEnd = useCallback(() => {
+    const index = draggingParamIdRef.current !== null ? PARAM_INDEX.get(draggingParamIdRef.current) : undefined;
+    if (index !== undefined) endParameterGesture(index);
     draggingParamIdRef.current = null;
   }, []);
 
@@ -321,6 +407,7 @@ export default function App() {
                 <EnvelopeSection
                   state={state}
                   setStateParam={setStateParam}
+                  setStateParams={setStateParams}
                   onDragStart={onDragStart}
                   onDragEnd={onDragEnd}
                   getParamMeta={getParamMeta}
@@ -349,6 +436,7 @@ export default function App() {
       </div>
 
       <div className="mt-2 flex justify-end gap-2">
+        <PerformancePanel />
         <Button
           variant="outline"
           size="sm"
@@ -1,8 +1,13 @@
 /**
- * Bridge to JUCE native backend (setParameter, getState).
- * C++ pushes updates via window.__ENVGEN__.updateParams(id, value) — set from App.
+ * Bridge to JUCE native backend (setParameter, getStateSince).
+ * C++ pushes batched updates via window.__ENVGEN__.updateParams([[index, value], ...]) — set from App.
+ * Parameters are addressed by index both ways: the plugin's ParameterTable indices, which
+ * PARAM_INDEX maps from IDs. String IDs stay on this side for state keys and labels. Writes
+ * are refused when the page's parameters don't match the plugin's (PARAM_LAYOUT_MATCHES).
  */
 
+import { PARAM_LAYOUT_MATCHES } from "./params";
+
 declare global {
   interface Window {
     __JUCE__?: {
@@ -12,10 +17,14 @@ declare global {
       };
       initialisationData?: {
         __juce__functions?: string[];
+        numLanes?: number[];
+        numSteps?: number[];
+        parameterIds?: string[][];
+        instanceId?: string[];
       };
     };
     __ENVGEN__?: {
-      updateParams?: (id: string, value: number) => void;
+      updateParams?: (updates: ParamUpdate[]) => void;
     };
   }
 }
@@ -54,24 +63,110 @@ function invoke(name: string, ...params: unknown[]): Promise<unknown> {
   });
 }
 
-export async function getState(): Promise<Record<string, number>> {
-  const result = await invoke("getState");
+/** Parameters changed after `version` (0 = all of them), plus the version to ask from next. */
+export type StateDelta = {
+  version: number;
+  /** [index into PARAMS, normalised value] */
+  changes: [number, number][];
+};
+
+export async function getStateSince(version: number): Promise<StateDelta> {
+  const result = await invoke("getStateSince", version);
   if (result != null && typeof result === "object" && !Array.isArray(result)) {
-    return result as Record<string, number>;
+    const delta = result as Partial<StateDelta>;
+    return { version: delta.version ?? 0, changes: delta.changes ?? [] };
+  }
+  return { version: 0, changes: [] };
+}
+
+function layoutMismatch(): Error {
+  return new Error("Parameter layout doesn't match the plugin; write refused");
+}
+
+// Parameters being dragged: their values go out at most once per animation frame
+const gestures = new Set<number>();
+const pendingDragValues = new Map<number, number>();
+let dragFlushScheduled = false;
+
+function flushDragValues(): void {
+  dragFlushScheduled = false;
+  for (const [index, value] of pendingDragValues) invoke("setParameter", index, value);
+  pendingDragValues.clear();
+}
+
+/** Normalised value for the parameter at `index` in PARAMS. */
+export function setParameter(index: number, value: number): Promise<unknown> {
+  if (!PARAM_LAYOUT_MATCHES) return Promise.reject(layoutMismatch());
+  if (!gestures.has(index)) return invoke("setParameter", index, value);
+
+  pendingDragValues.set(index, value);
+  if (!dragFlushScheduled) {
+    dragFlushScheduled = true;
+    requestAnimationFrame(flushDragValues);
+  }
+  return Promise.resolve(true);
+}
+
+/** Start of a drag: the host sees one gesture, and values are coalesced until endParameterGesture. */
+export function beginParameterGesture(index: number): void {
+  if (!PARAM_LAYOUT_MATCHES || gestures.has(index)) return;
+  gestures.add(index);
+  invoke("beginGesture", index).catch(() => {});
+}
+
+/** End of a drag: the final value is sent before the gesture closes. */
+export function endParameterGesture(index: number): void {
+  if (!gestures.delete(index)) return;
+  const value = pendingDragValues.get(index);
+  if (value !== undefined) {
+    pendingDragValues.delete(index);
+    invoke("setParameter", index, value);
   }
-  return {};
+  invoke("endGesture", index).catch(() => {});
 }
 
-export function setParameter(id: string, value: number): Promise<unknown> {
-  return invoke("setParameter", id, value);
+/** Several parameters as one edit: one gesture, one audio-thread update. */
+export function setParameters(updates: ParamUpdate[]): Promise<unknown> {
+  if (!PARAM_LAYOUT_MATCHES) return Promise.reject(layoutMismatch());
+  return invoke("setParameters", updates);
 }
 
 export function resetAllParameters(): Promise<unknown> {
   return invoke("resetAllParameters");
 }
 
+/** processBlock timing from the plugin's PerformanceMonitor (times in nanoseconds). */
+export type PerformanceStats = {
+  enabled: boolean;
+  blocks: number;
+  load: number;
+  avgNsPerSample: number;
+  p50NsPerSample: number;
+  p99NsPerSample: number;
+  maxNsPerSample: number;
+  overruns: number;
+  stageNsPerBlock: { parameters: number; render: number; gain: number; scope: number };
+  /** Half-octave buckets: bucket i counts blocks below 2^((i + 1) / 2) ns per sample. */
+  histogram: number[];
+};
+
+export function setPerformanceMonitoring(enabled: boolean): Promise<unknown> {
+  return invoke("setPerformanceMonitoring", enabled);
+}
+
+export async function getPerformanceStats(): Promise<PerformanceStats | null> {
+  const result = await invoke("getPerformanceStats");
+  if (result != null && typeof result === "object" && !Array.isArray(result)) {
+    return result as PerformanceStats;
+  }
+  return null;
+}
+
+/** [index into PARAMS, normalised value] */
+export type ParamUpdate = [number, number];
+
 export type EnvGenCallbacks = {
-  updateParams?: (id: string, value: number) => void;
+  updateParams?: (updates: ParamUpdate[]) => void;
 };
 
 export function setEnvGenCallbacks(callbacks: EnvGenCallbacks): void {
@@ -81,6 +176,6 @@ export function setEnvGenCallbacks(callbacks: EnvGenCallbacks): void {
   };
 }
 
-export function setUpdateParamsCallback(fn: (id: string, value: number) => void): void {
+export function setUpdateParamsCallback(fn: (updates: ParamUpdate[]) => void): void {
   setEnvGenCallbacks({ updateParams: fn });
 }
@@ -1,5 +1,7 @@
 /**
  * Parameter IDs and metadata (must match plugin createParameterLayout).
+ * Indices come from the plugin: it sends its parameter IDs in index order (ParameterTable,
+ * Source/ParameterTable.h) as initialisation data, and PARAM_INDEX is built from that list.
  * State is always linear normalized 0–1. Display = real value.
  */
 export interface ParamMeta {
@@ -15,15 +17,27 @@ export interface ParamMeta {
 }
 
 const RATE_CHOICES = ["1/1", "1/2", "1/4", "1/8", "1/16", "1/32"];
-const NUM_LANES = 8;
 
-function laneStepIds(laneNum: number): string[] {
-  return Array.from({ length: 16 }, (_, i) => `lane${laneNum}_step${i}`);
+/** Lane/step counts of the plugin build (sent as initialisation data); 8 × 16 in the browser dev server. */
+function buildCount(name: "numLanes" | "numSteps", fallback: number): number {
+  const value = window.__JUCE__?.initialisationData?.[name]?.[0];
+  return typeof value === "number" && value > 0 ? value : fallback;
+}
+
+export const NUM_LANES = buildCount("numLanes", 8);
+export const NUM_STEPS = buildCount("numSteps", 16);
+
+/** Envelope parameters of each lane, after its steps (IDs are `lane<n>_<slot>`). */
+export const LANE_SLOTS = ["attack", "hold", "decay", "rate", "destination", "amount"] as const;
+
+export function laneStepIds(laneNum: number): string[] {
+  return Array.from({ length: NUM_STEPS }, (_, i) => `lane${laneNum}_step${i}`);
 }
 
 function laneEnvelopeParamMeta(laneNum: number): ParamMeta[] {
   const prefix = `lane${laneNum}_`;
   return [
+    // Same order as LANE_SLOTS
     { id: `${prefix}attack`, label: "Attack", min: 0.001, max: 10, step: 0.001, unit: "s", type: "float", skew: 0.3 },
     { id: `${prefix}hold`, label: "Hold", min: 0, max: 10, step: 0.001, unit: "s", type: "float", skew: 0.3 },
     { id: `${prefix}decay`, label: "Decay", min: 0.001, max: 10, step: 0.001, unit: "s", type: "float", skew: 0.3 },
@@ -33,20 +47,18 @@ function laneEnvelopeParamMeta(laneNum: number): ParamMeta[] {
   ];
 }
 
-export const laneParamIds = (() => {
-  const ids: string[] = [];
-  for (let n = 1; n <= NUM_LANES; n++) {
-    ids.push(...laneStepIds(n));
-    ids.push(`lane${n}_attack`, `lane${n}_hold`, `lane${n}_decay`, `lane${n}_rate`, `lane${n}_destination`, `lane${n}_amount`);
-  }
-  return ids;
-})();
+/** Every parameter ID of one lane (laneNum is 1-based, as in the IDs). */
+export function laneParamIdsForLane(laneNum: number): string[] {
+  return [...laneStepIds(laneNum), ...LANE_SLOTS.map((slot) => `lane${laneNum}_${slot}`)];
+}
+
+export const laneParamIds = Array.from({ length: NUM_LANES }, (_, i) => laneParamIdsForLane(i + 1)).flat();
 
 export const PARAMS: ParamMeta[] = [
   { id: "inputGain", label: "Input Gain", min: -24, max: 24, step: 0.1, unit: "dB", type: "float" },
   { id: "outputGain", label: "Output Gain", min: -24, max: 24, step: 0.1, unit: "dB", type: "float" },
   { id: "dryPass", label: "Dry", type: "bool" },
-  { id: "numLanes", label: "Lanes", min: 0, max: 8, step: 1, type: "float" },
+  { id: "numLanes", label: "Lanes", min: 0, max: NUM_LANES, step: 1, type: "float" },
   ...Array.from({ length: NUM_LANES }, (_, laneIndex) => {
     const laneNum = laneIndex + 1;
     return [
@@ -56,6 +68,33 @@ export const PARAMS: ParamMeta[] = [
   }).flat(),
 ];
 
+/** The plugin's parameter IDs in index order; PARAMS order in the browser dev server. */
+const PLUGIN_PARAM_IDS: readonly string[] = (() => {
+  const ids = window.__JUCE__?.initialisationData?.parameterIds?.[0];
+  return Array.isArray(ids) && ids.every((id) => typeof id === "string") ? ids : PARAMS.map((p) => p.id);
+})();
+
+/** Index the plugin uses for each parameter ID. */
+export const PARAM_INDEX: ReadonlyMap<string, number> = new Map(PLUGIN_PARAM_IDS.map((id, i) => [id, i]));
+
+/** Parameter ID at a plugin index (for batches and state deltas from the plugin). */
+export function paramIdAt(index: number): string | undefined {
+  return PLUGIN_PARAM_IDS[index];
+}
+
+/**
+ * True when the page and the plugin have the same set of parameters. Otherwise the page was
+ * built for a different plugin version, and the bridge refuses every index write rather
+ * than risk changing the wrong parameter.
+ */
+export const PARAM_LAYOUT_MATCHES =
+  PLUGIN_PARAM_IDS.length === PARAMS.length && PARAMS.every((p) => PARAM_INDEX.has(p.id));
+
+if (!PARAM_LAYOUT_MATCHES)
+  console.error(
+    `Parameter layout mismatch: the page has ${PARAMS.length} parameters, the plugin ${PLUGIN_PARAM_IDS.length}; parameter writes are disabled`,
+  );
+
 export function getParamMeta(id: string): ParamMeta | undefined {
   return PARAMS.find((p) => p.id === id);
 }
@@ -0,0 +1,58 @@
+/**
+ * Last parameter state fetched from the plugin, kept per plugin instance, so a reloaded
+ * page or a reopened editor only asks getStateSince for what changed in the meantime.
+ */
+import { getStateSince } from "./bridge";
+import { paramIdAt } from "./params";
+
+type State = Record<string, number>;
+type CacheEntry = { version: number; state: State; savedAt: number };
+
+const STORAGE_KEY = "envgen-state-cache";
+const MAX_INSTANCES = 16;
+
+function getInstanceId(): string | undefined {
+  const id = window.__JUCE__?.initialisationData?.instanceId?.[0];
+  return typeof id === "string" && id.length > 0 ? id : undefined;
+}
+
+function readCache(): Record<string, CacheEntry> {
+  try {
+    const parsed: unknown = JSON.parse(window.localStorage.getItem(STORAGE_KEY) ?? "{}");
+    return parsed != null && typeof parsed === "object" ? (parsed as Record<string, CacheEntry>) : {};
+  } catch {
+    return {};
+  }
+}
+
+function writeEntry(instanceId: string, entry: CacheEntry): void {
+  try {
+    const cache = readCache();
+    cache[instanceId] = entry;
+    // Only the most recently used instances are worth keeping
+    const stale = Object.keys(cache)
+      .sort((a, b) => cache[b].savedAt - cache[a].savedAt)
+      .slice(MAX_INSTANCES);
+    for (const id of stale) delete cache[id];
+    window.localStorage.setItem(STORAGE_KEY, JSON.stringify(cache));
+  } catch {
+    // No storage: the next load just fetches everything
+  }
+}
+
+/** Full normalised state: this instance's cached snapshot plus everything changed since. */
+export async function loadState(): Promise<State> {
+  const instanceId = getInstanceId();
+  const cached = instanceId ? readCache()[instanceId] : undefined;
+  const delta = await getStateSince(cached?.version ?? 0);
+
+  // A version from the future means the cache isn't this instance's: the plugin sent everything
+  const state: State = cached && delta.version >= cached.version ? { ...cached.state } : {};
+  for (const [index, value] of delta.changes) {
+    const id = paramIdAt(index);
+    if (id) state[id] = value;
+  }
+
+  if (instanceId) writeEntry(instanceId, { version: delta.version, state, savedAt: Date.now() });
+  return state;
+}